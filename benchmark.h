@@ -0,0 +1,213 @@
+#pragma once
+#include <algorithm>
+#include <array>
+#include <chrono>
+#include <cmath>
+#include <cstdint>
+#include <format>
+#include <iostream>
+#include <string>
+#include <vector>
+
+#ifdef __linux__
+#include <linux/perf_event.h>
+#include <sys/syscall.h>
+#include <unistd.h>
+#endif
+
+namespace perf
+{
+struct event
+{
+  const char* name;
+  uint32_t type;
+  uint64_t config;
+};
+
+#ifdef __linux__
+constexpr uint64_t cache_miss(uint64_t cache)
+{
+  return cache | (PERF_COUNT_HW_CACHE_OP_READ << 8) | (PERF_COUNT_HW_CACHE_RESULT_MISS << 16);
+}
+
+inline constexpr std::array events = {
+  event{"cycles", PERF_TYPE_HARDWARE, PERF_COUNT_HW_CPU_CYCLES},
+  event{"instructions", PERF_TYPE_HARDWARE, PERF_COUNT_HW_INSTRUCTIONS},
+  event{"L1d miss", PERF_TYPE_HW_CACHE, cache_miss(PERF_COUNT_HW_CACHE_L1D)},
+  event{"LLC miss", PERF_TYPE_HW_CACHE, cache_miss(PERF_COUNT_HW_CACHE_LL)},
+  event{"dTLB miss", PERF_TYPE_HW_CACHE, cache_miss(PERF_COUNT_HW_CACHE_DTLB)},
+  event{"faults", PERF_TYPE_SOFTWARE, PERF_COUNT_SW_PAGE_FAULTS},
+};
+#else
+inline constexpr std::array<event, 0> events = {};
+#endif
+
+//NaN where the counter is not available (no perf support, paranoid setting, virtual machine)
+using sample = std::array<double, events.size()>;
+
+//user space counters of this thread and the threads it starts, opened once per process.
+//every event gets its own fd so a missing one does not take the others down
+class counters
+{
+  std::array<int, events.size()> fds;
+
+  struct reading
+  {
+    uint64_t value = 0;
+    uint64_t enabled = 0;
+    uint64_t running = 0;
+  };
+  std::array<reading, events.size()> start{};
+
+  counters()
+  {
+    fds.fill(-1);
+#ifdef __linux__
+    for (size_t i = 0; i < events.size(); ++i)
+    {
+      perf_event_attr attr{};
+      attr.size = sizeof(attr);
+      attr.type = events[i].type;
+      attr.config = events[i].config;
+      attr.exclude_kernel = 1;
+      attr.exclude_hv = 1;
+      attr.inherit = 1;
+      attr.read_format = PERF_FORMAT_TOTAL_TIME_ENABLED | PERF_FORMAT_TOTAL_TIME_RUNNING;
+      fds[i] = static_cast<int>(::syscall(SYS_perf_event_open, &attr, 0, -1, -1, 0));
+    }
+#endif
+  }
+  ~counters()
+  {
+#ifdef __linux__
+    for (int fd: fds)
+    {
+      if (fd >= 0)
+      {
+        ::close(fd);
+      }
+    }
+#endif
+  }
+
+  reading read(size_t i) const
+  {
+    reading now;
+#ifdef __linux__
+    if (fds[i] < 0 || ::read(fds[i], &now, sizeof(now)) != sizeof(now))
+    {
+      return {};
+    }
+#endif
+    return now;
+  }
+
+public:
+  static counters& instance()
+  {
+    static counters instance;
+    return instance;
+  }
+
+  void begin()
+  {
+    for (size_t i = 0; i < events.size(); ++i)
+    {
+      start[i] = read(i);
+    }
+  }
+  //counts since begin, scaled up if the kernel had to multiplex the counters
+  sample end() const
+  {
+    sample out;
+    for (size_t i = 0; i < events.size(); ++i)
+    {
+      reading now = read(i);
+      uint64_t running = now.running - start[i].running;
+      out[i] = fds[i] < 0 || running == 0
+                 ? NAN
+                 : static_cast<double>(now.value - start[i].value) *
+                     static_cast<double>(now.enabled - start[i].enabled) / running;
+    }
+    return out;
+  }
+};
+
+//per benchmark name totals over all calls, printed side by side by print_report
+struct result
+{
+  std::string name;
+  size_t calls = 0;
+  size_t runs = 0;
+  double ms = 0;
+  sample counts{};
+};
+
+inline std::vector<result>& results()
+{
+  static std::vector<result> results;
+  return results;
+}
+
+inline void record(const std::string& name, size_t runs, double ms, const sample& counts)
+{
+  auto& all = results();
+  auto it = std::ranges::find(all, name, &result::name);
+  if (it == all.end())
+  {
+    it = all.insert(all.end(), result{name});
+  }
+  ++it->calls;
+  it->runs += runs;
+  it->ms += ms;
+  for (size_t i = 0; i < counts.size(); ++i)
+  {
+    it->counts[i] += counts[i];
+  }
+}
+
+//per run averages of every benchmark, "-" for counters that are not available
+inline void print_report()
+{
+  std::string header = std::format("{:<48}{:>10}", "benchmark (per run)", "ms");
+  for (auto& event: events)
+  {
+    header += std::format("{:>14}", event.name);
+  }
+  std::cout << header << std::format("{:>8}\n", "IPC");
+  for (auto& result: results())
+  {
+    auto runs = static_cast<double>(result.runs);
+    std::string line = std::format("{:<48}{:>10.3f}", result.name, result.ms / runs);
+    for (double count: result.counts)
+    {
+      line += std::isnan(count) ? std::format("{:>14}", "-")
+                                : std::format("{:>14.0f}", count / runs);
+    }
+    double ipc = events.size() > 1 ? result.counts[1] / result.counts[0] : NAN;
+    line += std::isnan(ipc) ? std::format("{:>8}", "-") : std::format("{:>8.2f}", ipc);
+    std::cout << line << '\n';
+  }
+}
+} // namespace perf
+
+template <typename Map, typename Func>
+[[gnu::noinline]]
+void benchmark(const std::string& name, Map& map, Func&& func, size_t runs)
+{
+  auto& counters = perf::counters::instance();
+  counters.begin();
+  auto start = std::chrono::high_resolution_clock::now();
+  for (size_t i = 0; i < runs; ++i)
+  {
+    func(map);
+  }
+  auto end = std::chrono::high_resolution_clock::now();
+  perf::sample counts = counters.end();
+
+  auto duration_ms =
+      std::chrono::duration_cast<std::chrono::milliseconds>(end - start).count();
+
+  std::cout << name << " took " << duration_ms << " ms\n";
+  perf::record(name, runs, std::chrono::duration<double, std::milli>(end - start).count(), counts);
+}
@@ -0,0 +1,126 @@
+#pragma once
+#include "bump/HeapState.h"
+
+#include <format>
+#include <iterator>
+#include <span>
+#include <string>
+#include <string_view>
+
+#ifdef BUMP_TRACK_HEAP
+namespace bump
+{
+namespace detail
+{
+struct ArenaMetric
+{
+  const char* name;
+  const char* type;
+  const char* help;
+  uint64_t (*value)(const ArenaStats&);
+};
+
+inline constexpr ArenaMetric arena_metrics[] = {
+  {"current_bytes", "gauge", "Bytes currently allocated from the arena.",
+   [](const ArenaStats& s) -> uint64_t { return s.current; }},
+  {"peak_bytes", "gauge", "Highest number of bytes allocated from the arena.",
+   [](const ArenaStats& s) -> uint64_t { return s.peak; }},
+  {"reserved_bytes", "gauge", "Bytes owned by the arena, including its stack buffer.",
+   [](const ArenaStats& s) -> uint64_t { return s.reserved; }},
+  {"blocks", "gauge", "Blocks owned by the arena.",
+   [](const ArenaStats& s) -> uint64_t { return s.blocks; }},
+  {"tail_waste_bytes", "counter", "Bytes left unused at block ends.",
+   [](const ArenaStats& s) -> uint64_t { return s.tail_waste; }},
+  {"fast_hits", "counter", "Allocations served from the current block.",
+   [](const ArenaStats& s) -> uint64_t { return s.fast_hits; }},
+  {"slow_paths", "counter", "Allocations that had to move to another block.",
+   [](const ArenaStats& s) -> uint64_t { return s.slow_paths; }},
+  {"slow_path_p50_ns", "gauge", "Median slow path latency in nanoseconds.",
+   [](const ArenaStats& s) -> uint64_t { return s.slow_path_p50_ns; }},
+  {"slow_path_p99_ns", "gauge", "99th percentile slow path latency in nanoseconds.",
+   [](const ArenaStats& s) -> uint64_t { return s.slow_path_p99_ns; }},
+};
+
+//JSON string contents: quotes, backslashes and every control character escaped
+inline void append_json_escaped(std::string& out, std::string_view text)
+{
+  for (char c: text)
+  {
+    switch (c)
+    {
+    case '"': out += "\\\""; break;
+    case '\\': out += "\\\\"; break;
+    case '\n': out += "\\n"; break;
+    default:
+      if (static_cast<unsigned char>(c) < 0x20)
+      {
+        std::format_to(std::back_inserter(out), "\\u{:04x}", static_cast<int>(c));
+      }
+      else
+      {
+        out += c;
+      }
+    }
+  }
+}
+
+//Prometheus label value: the text format only knows \\, \" and \n, anything else stays as it is
+inline void append_prometheus_escaped(std::string& out, std::string_view text)
+{
+  for (char c: text)
+  {
+    switch (c)
+    {
+    case '"': out += "\\\""; break;
+    case '\\': out += "\\\\"; break;
+    case '\n': out += "\\n"; break;
+    default: out += c;
+    }
+  }
+}
+} // namespace detail
+
+//{"arenas":[{"name":"...","address":"0x...","current_bytes":...,...}]}
+inline std::string ToJson(std::span<const ArenaStats> arenas)
+{
+  std::string out = "{\"arenas\":[";
+  for (size_t i = 0; i < arenas.size(); ++i)
+  {
+    out += i ? ",{\"name\":\"" : "{\"name\":\"";
+    detail::append_json_escaped(out, arenas[i].name);
+    std::format_to(std::back_inserter(out), "\",\"address\":\"{}\"", arenas[i].address);
+    for (auto& metric: detail::arena_metrics)
+    {
+      std::format_to(std::back_inserter(out), ",\"{}\":{}", metric.name, metric.value(arenas[i]));
+    }
+    out += '}';
+  }
+  out += "]}";
+  return out;
+}
+
+//Prometheus text format, one bump_arena_<metric> family per stat labelled by arena and address
+inline std::string ToPrometheus(std::span<const ArenaStats> arenas)
+{
+  std::string out;
+  for (auto& metric: detail::arena_metrics)
+  {
+    auto name = std::format("bump_arena_{}{}", metric.name,
+                            std::string_view(metric.type) == "counter" ? "_total" : "");
+    std::format_to(std::back_inserter(out), "# HELP {} {}\n# TYPE {} {}\n", name, metric.help, name,
+                   metric.type);
+    for (auto& arena: arenas)
+    {
+      std::format_to(std::back_inserter(out), "{}{{arena=\"", name);
+      detail::append_prometheus_escaped(out, arena.name);
+      std::format_to(std::back_inserter(out), "\",address=\"{}\"}} {}\n", arena.address,
+                     metric.value(arena));
+    }
+  }
+  return out;
+}
+
+inline std::string ToJson() { return ToJson(HeapTracker::GetInstance().Snapshot()); }
+inline std::string ToPrometheus() { return ToPrometheus(HeapTracker::GetInstance().Snapshot()); }
+} // namespace bump
+#endif
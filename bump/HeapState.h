@@ -4,33 +4,172 @@
 
 #pragma once
 #include <atomic>
+#include <algorithm>
 #include <cstdio>
+#include <dlfcn.h>
+#include <mutex>
+#include <new>
 #include <unordered_set>
 #include <unordered_map>
 #include <print>
+#include <span>
+#include <string>
+#include <utility>
+#include <vector>
 
 #include "bump/default_formatter.h"
+#include "bump/histogram.h"
 #include <thread>
 #ifdef BUMP_TRACK_HEAP
 namespace bump
 {
+namespace detail
+{
+inline thread_local const char* site_tag = nullptr;
+}
+
+//names the allocation site of everything sampled on this thread until the scope ends
+class site_tag
+{
+    const char* previous;
+public:
+    explicit site_tag(const char* site) noexcept: previous(std::exchange(detail::site_tag, site)) {}
+    ~site_tag() noexcept { detail::site_tag = previous; }
+    site_tag(const site_tag&) = delete;
+    site_tag& operator=(const site_tag&) = delete;
+};
+
+//allocate calls of one arena sampled every Nth call, see BumpAllocator::SetSampling
+class SiteProfile
+{
+public:
+    struct Site
+    {
+        const void* key; //return address or site tag
+        bool tagged;
+        size_t count; //scaled up by the sampling interval
+        size_t bytes;
+        bool operator ==(const Site&)const = default;
+    };
+
+    void SetSampling(size_t every)
+    {
+        std::lock_guard lock(mutex);
+        this->every.store(every, std::memory_order_relaxed);
+        countdown = every;
+        if (every == 0)
+        {
+            sites.clear();
+        }
+    }
+    //also read by HeapTracker's reports on other threads
+    bool enabled() const noexcept
+    {
+        return every.load(std::memory_order_relaxed) != 0;
+    }
+    void Sample(const void* return_address, size_t bytes)
+    {
+        if (--countdown != 0)
+        {
+            return;
+        }
+        std::lock_guard lock(mutex);
+        size_t every = this->every.load(std::memory_order_relaxed);
+        countdown = every;
+        const char* tag = detail::site_tag;
+        const void* key = tag ? static_cast<const void*>(tag) : return_address;
+        auto [it, inserted] = sites.try_emplace(key, Site{key, tag != nullptr, 0, 0});
+        it->second.count += every;
+        it->second.bytes += bytes * every;
+    }
+    //sites with the most bytes first
+    std::vector<Site> Top(size_t count)
+    {
+        std::lock_guard lock(mutex);
+        std::vector<Site> top;
+        top.reserve(sites.size());
+        for (auto& site: sites)
+        {
+            top.push_back(site.second);
+        }
+        count = std::min(count, top.size());
+        auto most_bytes = [](const Site& a, const Site& b) { return a.bytes > b.bytes; };
+        std::partial_sort(top.begin(), top.begin() + count, top.end(), most_bytes);
+        top.resize(count);
+        return top;
+    }
+private:
+    std::mutex mutex;
+    std::atomic<size_t> every = 0;
+    size_t countdown = 0;
+    std::unordered_map<const void*, Site> sites;
+};
+
+//tag, symbol+offset of the return address if the symbol is exported (-rdynamic), raw address else
+inline std::string describe(const SiteProfile::Site& site)
+{
+    if (site.tagged)
+    {
+        return static_cast<const char*>(site.key);
+    }
+    Dl_info symbol;
+    if (::dladdr(site.key, &symbol) && symbol.dli_sname)
+    {
+        auto* address = static_cast<const char*>(site.key);
+        auto offset = address - static_cast<const char*>(symbol.dli_saddr);
+        return std::format("{}+{:#x}", symbol.dli_sname, offset);
+    }
+    return std::format("{}", site.key);
+}
+
 struct AllocInfo;
 struct AllocInfo
 {
     size_t total_malloc = 0;
     size_t total_free = 0;
+    size_t fast_hits = 0; //allocations served from the current block
+    size_t slow_paths = 0; //allocate_if_failed calls that had to move to another block
+    size_t blocks_added = 0;
+    size_t tail_waste = 0; //bytes left behind at block ends when moving on
+    size_t blocks = 0; //blocks the arena currently owns, including its stack buffer
+    size_t peak_used = 0; //highest usage seen at a frame restore or free
     bool operator ==(const AllocInfo&)const = default;
 };
+//point in time view of one arena, see HeapTracker::Snapshot
+struct ArenaStats
+{
+    const void* address;
+    std::string name;
+    size_t current; //bytes handed out
+    size_t peak;
+    size_t reserved; //bytes the arena owns
+    size_t blocks;
+    size_t tail_waste;
+    size_t fast_hits;
+    size_t slow_paths;
+    uint64_t slow_path_p50_ns;
+    uint64_t slow_path_p99_ns;
+};
 struct AllocMetha
 {
     AllocInfo info;
     const char* name;
     AllocInfo* address;
+    std::vector<SiteProfile::Site> top_sites;
+    latency_histogram slow_path_ns;
     bool operator ==(const AllocMetha&)const = default;
 };
 }
 
-default_formatter(bump::AllocInfo, "total_malloc: {}, total_free: {}", self.total_malloc, self.total_free);
+default_formatter(bump::AllocInfo,
+                  "total_malloc: {}, total_free: {}, "
+                  "fast_hits: {}, slow_paths: {}, blocks_added: {}, tail_waste: {}",
+                  self.total_malloc, self.total_free, self.fast_hits, self.slow_paths,
+                  self.blocks_added, self.tail_waste);
+default_formatter(bump::latency_histogram,
+                  "p50: {}ns, p90: {}ns, p99: {}ns, p99.9: {}ns, max: {}ns",
+                  self.percentile(50), self.percentile(90), self.percentile(99),
+                  self.percentile(99.9), self.max());
 
 namespace bump{
 
@@ -73,6 +212,26 @@ public:
             }
         });
     }
+    //structured stats of every live arena, see bump/HeapExport.h for JSON and Prometheus output
+    std::vector<ArenaStats> Snapshot()
+    {
+        std::vector<AllocMetha> arenas;
+        gatherState(arenas);
+        std::vector<ArenaStats> out;
+        out.reserve(arenas.size());
+        for (auto& arena: arenas)
+        {
+            const AllocInfo& info = arena.info;
+            size_t current = info.total_malloc - info.total_free;
+            out.push_back(ArenaStats{
+                arena.address, arena.name ? arena.name : "", current,
+                std::max(info.peak_used, current), info.total_malloc, info.blocks, info.tail_waste,
+                info.fast_hits, info.slow_paths, arena.slow_path_ns.percentile(50),
+                arena.slow_path_ns.percentile(99)});
+        }
+        return out;
+    }
+
     void Report()
     {
         std::vector<AllocMetha> new_state;
@@ -86,31 +245,44 @@ public:
 
 
 private:
-    void gatherState(std::vector<AllocMetha>& out_snapshot)
-    {
-        std::lock_guard lock(mutex);
-        out_snapshot.reserve(out_snapshot.size() + allocators.size());
-        for (auto& info: allocators)
-        {
-            out_snapshot.emplace_back(*info.first, info.second, info.first);
-        }
-    }
+    static constexpr size_t top_sites = 5;
+
+    void gatherState(std::vector<AllocMetha>& out_snapshot);
 
 
     void report(const std::span<AllocMetha>& state)
     {
         std::printf("---------------------REPORT---------------------\n");
         AllocInfo total;
+        latency_histogram total_slow_path_ns;
         for (auto& allocator: state){
             if (allocator.name)
             {
                 std::println("Allocator at {} '{}': {{{}}}",reinterpret_cast<void*>(allocator.address), allocator.name?allocator.name: "", allocator.info);
+                if (allocator.slow_path_ns.count())
+                {
+                    std::println("  slow path: {{{}}}", allocator.slow_path_ns);
+                }
+                for (auto& site: allocator.top_sites)
+                {
+                    std::println("  site {}: ~{} allocations, ~{} bytes", describe(site),
+                                 site.count, site.bytes);
+                }
             }
             total.total_malloc += allocator.info.total_malloc;
             total.total_free += allocator.info.total_free;
+            total.fast_hits += allocator.info.fast_hits;
+            total.slow_paths += allocator.info.slow_paths;
+            total.blocks_added += allocator.info.blocks_added;
+            total.tail_waste += allocator.info.tail_waste;
+            total_slow_path_ns.merge(allocator.slow_path_ns);
         }
 
         std::println("InTotal: {{{}}}", total);
+        if (total_slow_path_ns.count())
+        {
+            std::println("  slow path: {{{}}}", total_slow_path_ns);
+        }
     }
 };
 
@@ -134,7 +306,26 @@ struct TrackedAllocInfo: AllocInfo
         auto& instance = HeapTracker::GetInstance();
         std::lock_guard guard(instance.mutex);
         instance.allocators.erase(this);
+        delete slow_path_ns.load(std::memory_order_relaxed);
     }
+    //allocated with the first slow path, most arenas (small stack ones) never need the ~1.2 KB
+    void RecordSlowPath(uint64_t ns) noexcept
+    {
+        latency_histogram* histogram = slow_path_ns.load(std::memory_order_relaxed);
+        if (histogram == nullptr)
+        {
+            histogram = new (std::nothrow) latency_histogram();
+            if (histogram == nullptr)
+            {
+                return;
+            }
+            slow_path_ns.store(histogram, std::memory_order_release);
+        }
+        histogram->record_shared(ns);
+    }
+    SiteProfile sites;
+    //written by the owning thread only, HeapTracker snapshots it under its lock
+    std::atomic<latency_histogram*> slow_path_ns = nullptr;
 
     TrackedAllocInfo(const TrackedAllocInfo& other) = delete;
     TrackedAllocInfo(TrackedAllocInfo&& other) noexcept = delete;
@@ -143,6 +334,29 @@ struct TrackedAllocInfo: AllocInfo
 private:
 };
 
+inline void HeapTracker::gatherState(std::vector<AllocMetha>& out_snapshot)
+{
+    std::lock_guard lock(mutex);
+    out_snapshot.reserve(out_snapshot.size() + allocators.size());
+    for (auto& info: allocators)
+    {
+        //every registered AllocInfo is a TrackedAllocInfo, the lock keeps it alive
+        auto* tracked = static_cast<TrackedAllocInfo*>(info.first);
+        std::vector<SiteProfile::Site> top;
+        if (tracked->sites.enabled())
+        {
+            top = tracked->sites.Top(top_sites);
+        }
+        latency_histogram slow_path_ns;
+        if (auto* histogram = tracked->slow_path_ns.load(std::memory_order_acquire))
+        {
+            slow_path_ns = histogram->snapshot();
+        }
+        out_snapshot.emplace_back(*info.first, info.second, info.first, std::move(top),
+                                  slow_path_ns);
+    }
+}
+
 }
 #else
 
@@ -155,4 +369,12 @@ namespace Bump
         void Report(){}
     };
 }
+namespace bump
+{
+//allocation sites are only sampled with BUMP_TRACK_HEAP
+struct site_tag
+{
+    explicit site_tag(const char*) noexcept {}
+};
+}
 #endif
@@ -0,0 +1,42 @@
+#pragma once
+#include "bump/bump.h"
+#include "bump/thread_pool.h"
+
+#include <memory>
+#include <optional>
+#include <span>
+
+namespace bump
+{
+//reads many whole files in one batched pass, each file straight into a buffer carved from an
+//arena: no stream and no copy. Runs on io_uring (raw syscalls) where the kernel allows it,
+//on a thread_pool of pread loops otherwise
+class async_reader
+{
+  struct uring;
+  std::unique_ptr<uring> ring;
+  std::optional<thread_pool> pool;
+
+public:
+  struct file
+  {
+    const char* path;
+    std::span<std::byte> data; //in the arena, empty on error
+    int error; //errno of the failed open / stat / read, 0 on success
+  };
+
+  //`queue_depth` reads are in flight at most, use_io_uring = false forces the thread_pool
+  explicit async_reader(unsigned queue_depth = 256, bool use_io_uring = true);
+  ~async_reader();
+
+  async_reader(const async_reader&) = delete;
+  async_reader& operator=(const async_reader&) = delete;
+
+  bool uses_io_uring() const noexcept { return ring != nullptr; }
+
+  //reads every file, the results (in the order of `paths`) and the contents are allocated in
+  //`arena`. Files are sized with fstat, ones that report no size (procfs) come back empty.
+  //Throws std::bad_alloc if the arena is sealed or out of memory
+  std::span<file> read(BumpAllocator& arena, std::span<const char* const> paths);
+};
+} // namespace bump
@@ -0,0 +1,100 @@
+#pragma once
+#include "bump/bump.h"
+#include "bump/thread_pool.h"
+
+#include <iterator>
+#include <ranges>
+
+namespace bump
+{
+//forward range over the blocks of a frame, same bounds as Frame::Iterator
+class block_range
+{
+  Node* first;
+  std::byte* min;
+  Node* last_block;
+  std::byte* max;
+
+public:
+  class iterator
+  {
+    friend class block_range;
+    Node* current = nullptr;
+    std::byte* min = nullptr;
+    Node* last_block = nullptr;
+    std::byte* max = nullptr;
+
+    iterator(Node* current, std::byte* min, Node* last_block, std::byte* max) noexcept
+      : current(current), min(min), last_block(last_block), max(max)
+    {
+    }
+
+  public:
+    using iterator_concept = std::forward_iterator_tag;
+    using value_type = std::span<std::byte>;
+    using difference_type = std::ptrdiff_t;
+
+    iterator() = default;
+
+    std::span<std::byte> operator*() const noexcept
+    {
+      return {min, current == last_block ? max : current->index};
+    }
+    iterator& operator++() noexcept
+    {
+      if (current == last_block)
+      {
+        current = nullptr;
+        min = nullptr;
+      }
+      else
+      {
+        current = current->next;
+        min = current->payload;
+      }
+      return *this;
+    }
+    iterator operator++(int) noexcept
+    {
+      auto copy = *this;
+      ++*this;
+      return copy;
+    }
+    bool operator==(const iterator& other) const noexcept
+    {
+      return current == other.current && min == other.min;
+    }
+  };
+
+  block_range(BumpAllocator& allocator, const BumpAllocator::Frame& frame) noexcept
+    : first(frame.current), min(frame.iterator), last_block(allocator.current),
+      max(allocator.current->index)
+  {
+  }
+
+  iterator begin() const noexcept { return {first, min, last_block, max}; }
+  iterator end() const noexcept { return {}; }
+};
+
+static_assert(std::ranges::forward_range<block_range>);
+
+//runs func on every block of the range in parallel, grain > 0 splits large blocks into grain sized spans
+template <typename F>
+void for_each_block(thread_pool& pool, const block_range& blocks, F&& func, size_t grain = 0)
+{
+  std::vector<std::span<std::byte>> parts;
+  for (std::span<std::byte> block : blocks)
+  {
+    if (grain == 0)
+    {
+      parts.push_back(block);
+      continue;
+    }
+    for (size_t offset = 0; offset < block.size(); offset += grain)
+    {
+      parts.push_back(block.subspan(offset, std::min(grain, block.size() - offset)));
+    }
+  }
+  pool.parallel_for(parts.size(), [&](size_t i) { func(parts[i]); });
+}
+} // namespace bump
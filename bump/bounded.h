@@ -0,0 +1,83 @@
+#pragma once
+#include <cassert>
+#include <cstddef>
+#include <utility>
+
+namespace bump
+{
+//default exhaustion handler of bounded: the allocation fails with nullptr
+struct return_null
+{
+  void* operator()(size_t, size_t) const noexcept
+  {
+    return nullptr;
+  }
+};
+
+//fixed-capacity arena that never touches the heap: one compare and one bump per allocation,
+//the handler's result is returned once the buffer is full (any `void*(size_t bytes, size_t align)`)
+template<size_t Capacity, typename Handler = return_null>
+class bounded
+{
+  static constexpr size_t cache_line = 64;
+  static_assert(Capacity % cache_line == 0, "capacity has to be a whole number of cache lines");
+
+  alignas(cache_line) std::byte buffer[Capacity];
+  size_t offset = 0;
+  [[no_unique_address]] Handler handler;
+
+public:
+  using Frame = size_t;
+
+  bounded() noexcept = default;
+  explicit bounded(Handler handler) noexcept : handler(std::move(handler)) {}
+
+  //align has to be a power of two no bigger than a cache line
+  void* allocate(size_t bytes, size_t align = sizeof(size_t)) noexcept(noexcept(handler(0, 0)))
+  {
+    assert(align <= cache_line && (align & (align - 1)) == 0);
+    size_t begin = (offset + align - 1) & ~(align - 1);
+    if (bytes > Capacity - begin) [[unlikely]] //begin <= Capacity, it is a multiple of align
+    {
+      return handler(bytes, align);
+    }
+    offset = begin + bytes;
+    return buffer + begin;
+  }
+  template<typename T>
+  T* push() noexcept(noexcept(handler(0, 0)))
+  {
+    return static_cast<T*>(allocate(sizeof(T), alignof(T)));
+  }
+
+  Frame getFrame() const noexcept
+  {
+    return offset;
+  }
+  void restoreFrame(Frame frame) noexcept
+  {
+    assert(frame <= offset);
+    offset = frame;
+  }
+  void reset() noexcept
+  {
+    offset = 0;
+  }
+
+  size_t used() const noexcept
+  {
+    return offset;
+  }
+  size_t remaining() const noexcept
+  {
+    return Capacity - offset;
+  }
+  static constexpr size_t capacity() noexcept
+  {
+    return Capacity;
+  }
+
+  bounded(const bounded&) = delete;
+  bounded& operator=(const bounded&) = delete;
+};
+} // namespace bump
@@ -2,6 +2,7 @@
 // Created by Klemens Aimetti on 16.01.26.
 //
 #pragma once
+#include <algorithm>
 #include <array>
 #include <atomic>
 #include <cassert>
@@ -13,6 +14,7 @@
 #include <type_traits>
 #include <vector>
 #include <bit>
+#include <cstdint>
 
 #ifndef NDEBUG
 
@@ -21,6 +23,8 @@
 #define DEBUG_ONLY(X)
 #endif
 
+#include "bump/numa.h"
+
 #ifdef BUMP_TRACK_HEAP
 #include "bump/HeapState.h"
 #define IF_TRACKING(X) X
@@ -35,10 +39,21 @@ struct Node
 {
   std::byte *index;
   std::byte *end;
+  std::byte *zeroed; //the block is known to be zero from here (or index, if that is higher) to end
   Node *next;
-  std::byte payload[];
+  size_t before; //bytes used in the blocks in front of this one
+  size_t last_used; //frame epoch the block was last moved into
+  int numa_node; //numa::none for blocks from std::allocator
+  bool mapped; //holds a mapped file (see map_file), which is no arena memory and counts nowhere
+  alignas(std::max_align_t) std::byte payload[];
 
-  Node(size_t cap, Node *nxt) noexcept : index(payload), end(index + cap), next(nxt) {}
+  static constexpr size_t pages_released = SIZE_MAX;
+
+  Node(size_t cap, Node *nxt) noexcept
+    : index(payload), end(index + cap), zeroed(end), next(nxt), before(0), last_used(0),
+      numa_node(numa::none), mapped(false)
+  {
+  }
 
   size_t remaining() const noexcept { return end - index; }
   size_t used()const
@@ -53,22 +68,77 @@ struct Node
   {
     return end - reinterpret_cast<const std::byte*>(this);
   }
+  //moves index back, what it handed out so far stays below the zero watermark
+  void rewind(std::byte* to) noexcept
+  {
+    zeroed = std::max(zeroed, index);
+    index = to;
+  }
   bool corrupt()const
   {
     return index < payload || index > end;
   }
 };
 
+struct refill_slot;
+
+static_assert(offsetof(Node, payload) == sizeof(Node), "blocks are sized as header + payload");
+
+//learned arena size of a call site, arenas using it size their first heap block after it
+struct usage_profile
+{
+  std::atomic<size_t> peak = 0;
+
+  //takes new peaks immediately and decays slowly, so a single spike does not stick forever
+  void record(size_t used) noexcept;
+  size_t hint() const noexcept
+  {
+    return peak.load(std::memory_order_relaxed);
+  }
+  static usage_profile& named(const char* site);
+};
+
+//which unused blocks behind the current one an arena gives back, checked every `interval` restores
+struct trim_policy
+{
+  size_t max_idle_frames = 0; //0 keeps idle blocks
+  size_t retained_budget = SIZE_MAX; //bytes of unused blocks kept around
+  size_t interval = 64;
+  bool release_pages = false; //madvise the pages away instead of freeing the block
+};
+
+//read-only file mapping spliced into the block chain, owned by the frame it was created in
+struct MappedRegion
+{
+  MappedRegion* previous;
+  Node* before;
+  Node* node;
+  void* base;
+  size_t length;
+};
+
 struct BumpAllocator
 {
   IF_TRACKING(TrackedAllocInfo info);
   Node *root = nullptr;
   Node *current = nullptr;
+  MappedRegion* regions = nullptr;
+  usage_profile own_usage;
+  usage_profile* profile = &own_usage;
+  size_t peak = 0; //high-water mark since the arena was last empty
+  std::optional<trim_policy> trimming;
+  size_t epoch = 0;
+  int numa_node = numa::none;
+  bool prefault_blocks = false;
+  refill_slot* refill = nullptr;
+  std::pmr::memory_resource* upstream = nullptr; //nullptr: std::allocator (or NUMA / refiller)
+  std::byte* sealed_end = nullptr; //real end of the current block while the arena is sealed
 public:
   struct Frame
   {
     Node* current;
     std::byte * iterator;
+    MappedRegion* regions;
 
     class Iterator
     {
@@ -89,7 +159,7 @@ public:
       Iterator copy(){return *this;}
       bool fragmented()const
       {
-        return current == last_block;
+        return current != last_block;
       }
     };
   };
@@ -102,24 +172,142 @@ public:
   size_t remaining(size_t align) noexcept;
   size_t remainingBytes() noexcept;
   std::byte* end()noexcept;
+  //for code that writes past end() before it allocates (speculative formatting): the bytes up to
+  //`upto` are no longer zero, allocate_zeroed clears them if it hands them out later
+  void mark_written(std::byte* upto) noexcept
+  {
+    current->zeroed = std::max(current->zeroed, upto);
+  }
   template <typename T> T *push() noexcept
   {
     return static_cast<T *>(allocate(sizeof(T), alignof(T)));
   }
+  //zero bytes for a T, not constructed
+  template <typename T> T *push_zeroed() noexcept
+  {
+    return static_cast<T *>(allocate_zeroed(sizeof(T), alignof(T)));
+  }
 
   void SetName(const char* name)
   {
     IF_TRACKING(info.SetName(name));
   }
+  void SetProfile(usage_profile& usage) noexcept
+  {
+    profile = &usage;
+  }
+  void SetProfile(const char* site)
+  {
+    SetProfile(usage_profile::named(site));
+  }
+  void SetTrimPolicy(std::optional<trim_policy> policy) noexcept
+  {
+    assert(!policy || policy->interval != 0);
+    trimming = policy;
+  }
+  //places new heap blocks on a NUMA node (or numa::local), recycled blocks stay on their node.
+  //has no effect on arenas with an upstream resource
+  void SetNumaNode(int node) noexcept
+  {
+    numa_node = node;
+  }
+  //faults new heap blocks in at once instead of page by page on first use
+  void SetPrefault(bool enabled) noexcept
+  {
+    prefault_blocks = enabled;
+  }
+  //samples every Nth allocation with the code that asked for it (or site_tag) for HeapTracker's
+  //per-site report: allocate's caller, BumpGuard's user, the caller allocate_inline is inlined
+  //into. 0 turns sampling off. Does nothing without BUMP_TRACK_HEAP
+  void SetSampling(size_t every)
+  {
+    IF_TRACKING(info.sites.SetSampling(every));
+  }
+  //lets the background refiller keep a faulted block ready for the next allocate_if_failed,
+  //arenas with an upstream resource ignore it
+  void SetRefill(bool enabled) noexcept;
+  std::pmr::memory_resource* GetUpstream() const noexcept
+  {
+    return upstream;
+  }
+  //applies the trim policy to the blocks behind the current one
+  void trim() noexcept;
+  //bytes handed out, including alignment padding, excluding the unused tails of earlier blocks
+  size_t used() const noexcept
+  {
+    return current->before + (current->mapped ? 0 : current->used());
+  }
+  size_t high_water() const noexcept
+  {
+    return std::max(peak, used());
+  }
   void *allocate(size_t bytes, size_t align = sizeof(size_t)) noexcept;
+  //allocate on behalf of a wrapper (memory resource, typed allocator), sampling reports `site`
+  //instead of the wrapper as the allocation site
+  void* allocate(size_t bytes, size_t align, const void* site) noexcept;
+  //allocate with the fast path inlined into the caller, for typed allocators on hot paths
+  void* allocate_inline(size_t bytes, size_t align) noexcept
+  {
+#ifdef BUMP_TRACK_HEAP
+    if (info.sites.enabled()) [[unlikely]]
+    {
+      return allocate_sampled(bytes, align);
+    }
+#endif
+    auto raw = reinterpret_cast<std::uintptr_t>(current->index);
+    auto* aligned_ptr = reinterpret_cast<std::byte*>((raw + align - 1) & ~(align - 1));
+    if (aligned_ptr + bytes <= current->end) [[likely]]
+    {
+      IF_TRACKING(info.total_free -= (aligned_ptr + bytes) - current->index);
+      IF_TRACKING(++info.fast_hits);
+      current->index = aligned_ptr + bytes;
+      return aligned_ptr;
+    }
+    return allocate_if_failed(bytes, align);
+  }
+  //zero-filled allocation. Only bytes the block handed out before are cleared, memory fresh from
+  //the OS (NUMA blocks, pages given back by trim) is known to be zero already
+  void* allocate_zeroed(size_t bytes, size_t align = sizeof(size_t)) noexcept;
   void *try_allocate(size_t bytes, size_t align = sizeof(size_t)) noexcept;
   void *allocate_if_failed(size_t bytes, size_t align = sizeof(size_t)) noexcept;
+  //grows (or shrinks) the most recent allocation without moving it, fails if anything was allocated after it
+  bool try_extend(void* allocation, size_t bytes, size_t new_bytes) noexcept;
+  //makes sure the next `bytes` are allocated contiguous, switching to a bigger block if needed
+  void reserve(size_t bytes) noexcept;
+
+  //maps a file read-only as its own block, the mapping is released when the frame is restored
+  std::optional<Frame::Iterator> map_file(const char* path) noexcept;
+  //reads a file chunk by chunk directly into arena blocks
+  std::optional<Frame::Iterator> read_file(const char* path, size_t chunk = 64 * 1024) noexcept;
+
+  //no allocation, restoreFrame or try_extend after this: the current block's end is pulled down
+  //to its index so every allocation returns nullptr, try_extend returns false and restoreFrame
+  //(a BumpGuard going out of scope) keeps everything. free() undoes it. What cannot return
+  //nullptr (BumpGuard, std_allocator, soa, flat_map, async_reader, task_group) throws
+  //std::bad_alloc, coroutine frames and redirected allocations go to the heap
+  void seal() noexcept
+  {
+    if (!sealed_end)
+    {
+      sealed_end = current->end;
+      current->end = current->index;
+    }
+  }
+  bool sealed() const noexcept
+  {
+    return sealed_end != nullptr;
+  }
 
   void free() noexcept;
 
   ~BumpAllocator() noexcept;
 
-  BumpAllocator(std::byte* stack_buffer, size_t capacity) noexcept;
+  //heap blocks come from `upstream` if given, e.g. a BumpGuard of a parent arena. The resource has
+  //to outlive the arena, blocks from a parent frame are gone for good once that frame unwinds.
+  //Once the upstream is out of memory allocations return nullptr.
+  //stack_buffer holds the root block and has to be aligned like a Node
+  BumpAllocator(std::byte* stack_buffer, size_t capacity,
+                std::pmr::memory_resource* upstream = nullptr) noexcept;
 
 private:
   BumpAllocator(const BumpAllocator &other) = delete;
@@ -129,6 +317,19 @@ private:
   BumpAllocator &operator=(const BumpAllocator &other) = delete;
 
   BumpAllocator &operator=(BumpAllocator &&other) noexcept = delete;
+  void unmap_region() noexcept;
+  //never inlined: its return address is the spot allocate_inline was inlined into
+  [[gnu::noinline]] void* allocate_sampled(size_t bytes, size_t align) noexcept;
+  //nullptr if the upstream is out of memory
+  Node* new_block(size_t capacity) noexcept;
+  Node* upstream_block(size_t capacity) noexcept;
+  void release_block(Node* node) noexcept;
+  //raw block sources without tracking, shared with the refiller thread
+  static Node* allocate_block(size_t capacity, int numa_node) noexcept;
+  static void deallocate_block(Node* node) noexcept;
+  static void prefault(Node* node) noexcept;
+  friend class refiller;
+  friend struct refill_slot;
   friend class AllocatorPool;
   friend class BumpGuard;
   friend class OwningBumpGuardBase;
@@ -138,13 +339,24 @@ private:
 template<size_t stack_bytes = 4096>
 class allocator
 {
-  std::byte buffer[stack_bytes];
+  alignas(Node) std::byte buffer[stack_bytes]; //the root Node header is placed at its start
   BumpAllocator bumpAllocator;
 public:
   allocator()noexcept
   :bumpAllocator(buffer, stack_bytes)
   {
   }
+  explicit allocator(std::pmr::memory_resource* upstream)noexcept
+  :bumpAllocator(buffer, stack_bytes, upstream)
+  {
+  }
+  //names the arena and presizes it from earlier arenas with the same name
+  explicit allocator(const char* name, std::pmr::memory_resource* upstream = nullptr)
+  :bumpAllocator(buffer, stack_bytes, upstream)
+  {
+    bumpAllocator.SetName(name);
+    bumpAllocator.SetProfile(name);
+  }
   operator BumpAllocator& ()noexcept
   {
     return bumpAllocator;
@@ -298,6 +510,10 @@ public:
           remaining -= cell_size;
         }
         ptr = allocator.allocate_if_failed(bucket_size, align);
+        if (ptr == nullptr)
+        {
+          throw std::bad_alloc(); //sealed or out of memory
+        }
       }
       Node* allocation = new (ptr)Node();
       return allocation->payload();
@@ -402,12 +618,17 @@ public:
 
   BumpGuard(BumpAllocator &allocator) noexcept : allocator(allocator), frame(allocator.getFrame()){}
 
-  void* do_allocate(size_t bytes, size_t alignment)noexcept final
+  //a memory_resource never returns nullptr: a sealed or exhausted arena throws std::bad_alloc
+  void* do_allocate(size_t bytes, size_t alignment) final
   {
-    DEBUG_ONLY(assert(checksum == MAGIC_NUMBER);
-      allocations++;
-    )
-    return allocator.allocate(bytes, alignment);
+    DEBUG_ONLY(assert(checksum == MAGIC_NUMBER);)
+    void* allocation = allocator.allocate(bytes, alignment, __builtin_return_address(0));
+    if (allocation == nullptr)
+    {
+      throw std::bad_alloc();
+    }
+    DEBUG_ONLY(allocations++;)
+    return allocation;
   }
 
   void do_deallocate(void* p, size_t bytes, size_t alignment)noexcept final
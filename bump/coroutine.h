@@ -0,0 +1,72 @@
+#pragma once
+#include "bump/bump.h"
+#include "bump/scoped_arena.h"
+
+#include <new>
+#include <type_traits>
+
+#if defined(__GNUC__) && !defined(__clang__)
+//coroutine frames are allocated by arena_promise's variadic operator new and freed by its sized
+//usual operator delete, the pairing the standard prescribes for coroutines. GCC takes it for a
+//mismatch at every coroutine using the promise, so the warning is off where this is included
+#pragma GCC diagnostic ignored "-Wmismatched-new-delete"
+#endif
+
+namespace bump
+{
+//base for promise types that puts coroutine frames into an arena: the first coroutine argument
+//convertible to BumpAllocator& (an arena, bump::allocator or BumpGuard), else the thread's
+//scoped_arena, else the global heap, which also takes the frame if the arena is sealed or out
+//of memory. Arena frames are released when the arena's frame unwinds, so the coroutine has to
+//be destroyed before that. Destroying chains in LIFO order gives the memory back right away.
+struct arena_promise
+{
+private:
+  static constexpr size_t header = __STDCPP_DEFAULT_NEW_ALIGNMENT__;
+
+  template<typename Arg>
+  static BumpAllocator* arena_of(Arg& arg) noexcept
+  {
+    if constexpr (std::is_convertible_v<Arg&, BumpAllocator&>)
+    {
+      return &static_cast<BumpAllocator&>(arg);
+    }
+    else
+    {
+      return nullptr;
+    }
+  }
+
+public:
+  template<typename... Args>
+  static void* operator new(size_t size, Args&... args)
+  {
+    BumpAllocator* arena = nullptr;
+    ((arena = arena ? arena : arena_of(args)), ...);
+    if (arena == nullptr)
+    {
+      arena = scoped_arena::current();
+    }
+    //the header remembers where the frame came from, nullptr for the global heap
+    auto* base = arena ? static_cast<std::byte*>(arena->allocate(header + size, header)) : nullptr;
+    if (base == nullptr)
+    {
+      arena = nullptr;
+      base = static_cast<std::byte*>(::operator new(header + size));
+    }
+    *reinterpret_cast<BumpAllocator**>(base) = arena;
+    return base + header;
+  }
+
+  static void operator delete(void* frame, size_t size) noexcept
+  {
+    auto* base = static_cast<std::byte*>(frame) - header;
+    if (BumpAllocator* arena = *reinterpret_cast<BumpAllocator**>(base))
+    {
+      arena->try_extend(base, header + size, 0);
+      return;
+    }
+    ::operator delete(base, header + size);
+  }
+};
+} // namespace bump
@@ -0,0 +1,410 @@
+#pragma once
+#include "bump/bump.h"
+#include <cstdint>
+#include <cstring>
+#include <functional>
+#include <iterator>
+#include <new>
+#include <tuple>
+#include <utility>
+
+#if defined(__SSE2__)
+#include <emmintrin.h>
+#endif
+
+namespace bump
+{
+namespace detail
+{
+//control byte per slot: full slots store the low 7 bits of the hash, empty/deleted are negative
+static constexpr int8_t ctrl_empty = -128;
+static constexpr int8_t ctrl_deleted = -2;
+
+struct group
+{
+  static constexpr size_t width = 16;
+#if defined(__SSE2__)
+  __m128i ctrl;
+
+  explicit group(const int8_t* pos) noexcept
+    : ctrl(_mm_loadu_si128(reinterpret_cast<const __m128i*>(pos)))
+  {
+  }
+  uint32_t match(int8_t h2) const noexcept
+  {
+    return _mm_movemask_epi8(_mm_cmpeq_epi8(_mm_set1_epi8(h2), ctrl));
+  }
+  uint32_t match_free() const noexcept //empty or deleted
+  {
+    return _mm_movemask_epi8(ctrl);
+  }
+#else
+  int8_t ctrl[width];
+
+  explicit group(const int8_t* pos) noexcept
+  {
+    std::memcpy(ctrl, pos, width);
+  }
+  uint32_t match(int8_t h2) const noexcept
+  {
+    uint32_t mask = 0;
+    for (size_t i = 0; i < width; ++i)
+      mask |= uint32_t{ctrl[i] == h2} << i;
+    return mask;
+  }
+  uint32_t match_free() const noexcept
+  {
+    uint32_t mask = 0;
+    for (size_t i = 0; i < width; ++i)
+      mask |= uint32_t{ctrl[i] < 0} << i;
+    return mask;
+  }
+#endif
+  uint32_t match_empty() const noexcept
+  {
+    return match(ctrl_empty);
+  }
+};
+
+//triangular probing over groups, visits every group once for power of two capacities
+struct probe
+{
+  size_t mask;
+  size_t offset;
+  size_t index = 0;
+
+  probe(size_t hash, size_t mask) noexcept : mask(mask), offset(hash & mask) {}
+
+  size_t offset_at(size_t i) const noexcept { return (offset + i) & mask; }
+  void next() noexcept
+  {
+    index += group::width;
+    offset = (offset + index) & mask;
+  }
+};
+
+inline size_t mix_hash(size_t h) noexcept
+{
+  h ^= h >> 33;
+  h *= 0xff51afd7ed558ccdULL;
+  h ^= h >> 33;
+  return h;
+}
+} // namespace detail
+
+//open addressing hash map living in a bump arena.
+//slots and control bytes share one allocation ([slots][ctrl]), so growing the most recent table
+//extends it in place and rehashes without leaving the old table behind.
+//memory is never returned, the map is released by unwinding the frame it was created in.
+//growing on a sealed or exhausted arena throws std::bad_alloc and leaves the map as it is.
+template <typename K, typename V, typename Hash = std::hash<K>, typename Eq = std::equal_to<K>>
+class flat_map
+{
+public:
+  using key_type = K;
+  using mapped_type = V;
+  using value_type = std::pair<K, V>;
+
+private:
+  using group = detail::group;
+  static constexpr size_t cloned_bytes = group::width - 1;
+
+  BumpAllocator* allocator;
+  value_type* slots = nullptr;
+  int8_t* ctrl = nullptr;
+  size_t capacity_ = 0;
+  size_t size_ = 0;
+  size_t growth_left = 0;
+
+  static size_t max_load(size_t capacity) noexcept { return capacity - capacity / 8; }
+  static size_t storage_bytes(size_t capacity) noexcept
+  {
+    return capacity * sizeof(value_type) + capacity + cloned_bytes;
+  }
+  static size_t h1(size_t hash) noexcept { return hash >> 7; }
+  static int8_t h2(size_t hash) noexcept { return static_cast<int8_t>(hash & 0x7f); }
+  static size_t hash_of(const K& key) noexcept { return detail::mix_hash(Hash{}(key)); }
+
+  size_t mask() const noexcept { return capacity_ - 1; }
+
+  void set_ctrl(size_t i, int8_t h) noexcept
+  {
+    ctrl[i] = h;
+    ctrl[((i - cloned_bytes) & mask()) + cloned_bytes] = h;
+  }
+
+  size_t find_index(const K& key, size_t hash) const noexcept
+  {
+    if (capacity_ == 0)
+      return 0;
+    detail::probe seq(h1(hash), mask());
+    while (true)
+    {
+      group g(ctrl + seq.offset);
+      for (uint32_t bits = g.match(h2(hash)); bits; bits &= bits - 1)
+      {
+        size_t i = seq.offset_at(std::countr_zero(bits));
+        if (Eq{}(slots[i].first, key))
+          return i;
+      }
+      if (g.match_empty())
+        return capacity_;
+      seq.next();
+    }
+  }
+
+  size_t find_free(size_t hash) const noexcept
+  {
+    detail::probe seq(h1(hash), mask());
+    while (true)
+    {
+      group g(ctrl + seq.offset);
+      if (uint32_t bits = g.match_free())
+        return seq.offset_at(std::countr_zero(bits));
+      seq.next();
+    }
+  }
+
+  //full -> deleted, deleted -> empty, then reinserts every "deleted" slot within the same storage
+  void rehash_in_place() noexcept
+  {
+    for (size_t i = 0; i < capacity_; ++i)
+      ctrl[i] = ctrl[i] >= 0 ? detail::ctrl_deleted : detail::ctrl_empty;
+    std::memcpy(ctrl + capacity_, ctrl, cloned_bytes);
+
+    for (size_t i = 0; i < capacity_; ++i)
+    {
+      if (ctrl[i] != detail::ctrl_deleted)
+        continue;
+      size_t hash = hash_of(slots[i].first);
+      size_t start = h1(hash) & mask();
+      size_t target = find_free(hash);
+      auto probe_group = [&](size_t pos) { return ((pos - start) & mask()) / group::width; };
+
+      if (probe_group(target) == probe_group(i))
+      {
+        set_ctrl(i, h2(hash));
+        continue;
+      }
+      if (ctrl[target] == detail::ctrl_empty)
+      {
+        std::construct_at(slots + target, std::move(slots[i]));
+        std::destroy_at(slots + i);
+        set_ctrl(target, h2(hash));
+        set_ctrl(i, detail::ctrl_empty);
+      }
+      else
+      {
+        using std::swap;
+        set_ctrl(target, h2(hash));
+        swap(slots[i], slots[target]);
+        --i;
+      }
+    }
+    growth_left = max_load(capacity_) - size_;
+  }
+
+  void resize(size_t new_capacity)
+  {
+    if (capacity_ != 0 &&
+        allocator->try_extend(slots, storage_bytes(capacity_), storage_bytes(new_capacity)))
+    {
+      auto* new_ctrl = reinterpret_cast<int8_t*>(slots + new_capacity);
+      std::memmove(new_ctrl, ctrl, capacity_);
+      std::memset(new_ctrl + capacity_, detail::ctrl_empty, new_capacity - capacity_ + cloned_bytes);
+      ctrl = new_ctrl;
+      capacity_ = new_capacity;
+      rehash_in_place();
+      return;
+    }
+
+    auto* storage = static_cast<value_type*>(
+      allocator->allocate(storage_bytes(new_capacity), alignof(value_type)));
+    if (storage == nullptr)
+      throw std::bad_alloc();
+    auto* old_slots = std::exchange(slots, storage);
+    auto* old_ctrl = ctrl;
+    size_t old_capacity = capacity_;
+
+    ctrl = reinterpret_cast<int8_t*>(slots + new_capacity);
+    std::memset(ctrl, detail::ctrl_empty, new_capacity + cloned_bytes);
+    capacity_ = new_capacity;
+
+    for (size_t i = 0; i < old_capacity; ++i)
+    {
+      if (old_ctrl[i] < 0)
+        continue;
+      size_t hash = hash_of(old_slots[i].first);
+      size_t target = find_free(hash);
+      set_ctrl(target, h2(hash));
+      std::construct_at(slots + target, std::move(old_slots[i]));
+      std::destroy_at(old_slots + i);
+    }
+    growth_left = max_load(capacity_) - size_;
+  }
+
+  size_t prepare_insert(size_t hash)
+  {
+    if (growth_left == 0)
+    {
+      if (capacity_ != 0 && size_ <= max_load(capacity_) / 2)
+        rehash_in_place(); //mostly tombstones, reclaim them instead of growing
+      else
+        resize(capacity_ == 0 ? group::width : capacity_ * 2);
+    }
+    size_t target = find_free(hash);
+    growth_left -= ctrl[target] == detail::ctrl_empty;
+    set_ctrl(target, h2(hash));
+    ++size_;
+    return target;
+  }
+
+  void destroy_slots() noexcept
+  {
+    if constexpr (!std::is_trivially_destructible_v<value_type>)
+    {
+      for (size_t i = 0; i < capacity_; ++i)
+        if (ctrl[i] >= 0)
+          std::destroy_at(slots + i);
+    }
+  }
+
+public:
+  template <bool Const> class basic_iterator
+  {
+    friend class flat_map;
+    friend class basic_iterator<!Const>;
+    using slot_ptr = std::conditional_t<Const, const std::pair<K, V>*, std::pair<K, V>*>;
+    const int8_t* ctrl = nullptr;
+    const int8_t* ctrl_end = nullptr;
+    slot_ptr slot = nullptr;
+
+    basic_iterator(const int8_t* ctrl, const int8_t* ctrl_end, slot_ptr slot) noexcept
+      : ctrl(ctrl), ctrl_end(ctrl_end), slot(slot)
+    {
+    }
+    void skip_free() noexcept
+    {
+      while (ctrl != ctrl_end && *ctrl < 0)
+      {
+        ++ctrl;
+        ++slot;
+      }
+    }
+
+  public:
+    using iterator_category = std::forward_iterator_tag;
+    using value_type = std::pair<K, V>;
+    using difference_type = std::ptrdiff_t;
+    using reference = std::conditional_t<Const, const value_type&, value_type&>;
+    using pointer = slot_ptr;
+
+    basic_iterator() = default;
+    operator basic_iterator<true>() const noexcept { return {ctrl, ctrl_end, slot}; }
+
+    reference operator*() const noexcept { return *slot; }
+    pointer operator->() const noexcept { return slot; }
+    basic_iterator& operator++() noexcept
+    {
+      ++ctrl;
+      ++slot;
+      skip_free();
+      return *this;
+    }
+    basic_iterator operator++(int) noexcept
+    {
+      auto copy = *this;
+      ++*this;
+      return copy;
+    }
+    bool operator==(const basic_iterator& other) const noexcept { return ctrl == other.ctrl; }
+  };
+  using iterator = basic_iterator<false>;
+  using const_iterator = basic_iterator<true>;
+
+  explicit flat_map(BumpAllocator& allocator, size_t capacity = 0) : allocator(&allocator)
+  {
+    reserve(capacity);
+  }
+
+  flat_map(const flat_map&) = delete;
+  flat_map& operator=(const flat_map&) = delete;
+  flat_map(flat_map&& other) noexcept
+    : allocator(other.allocator), slots(std::exchange(other.slots, nullptr)),
+      ctrl(std::exchange(other.ctrl, nullptr)),
+      capacity_(std::exchange(other.capacity_, 0)), size_(std::exchange(other.size_, 0)),
+      growth_left(std::exchange(other.growth_left, 0))
+  {
+  }
+
+  ~flat_map() requires std::is_trivially_destructible_v<value_type> = default;
+  ~flat_map() { destroy_slots(); }
+
+  size_t size() const noexcept { return size_; }
+  bool empty() const noexcept { return size_ == 0; }
+  size_t capacity() const noexcept { return capacity_; }
+
+  void reserve(size_t count)
+  {
+    size_t new_capacity = capacity_ == 0 ? group::width : capacity_;
+    while (max_load(new_capacity) < count)
+      new_capacity *= 2;
+    if (count != 0 && new_capacity != capacity_)
+      resize(new_capacity);
+  }
+
+  iterator begin() noexcept
+  {
+    iterator it(ctrl, ctrl + capacity_, slots);
+    it.skip_free();
+    return it;
+  }
+  iterator end() noexcept { return {ctrl + capacity_, ctrl + capacity_, slots + capacity_}; }
+  const_iterator begin() const noexcept { return const_cast<flat_map*>(this)->begin(); }
+  const_iterator end() const noexcept { return const_cast<flat_map*>(this)->end(); }
+
+  iterator find(const K& key) noexcept
+  {
+    size_t i = find_index(key, hash_of(key));
+    return {ctrl + i, ctrl + capacity_, slots + i};
+  }
+  const_iterator find(const K& key) const noexcept { return const_cast<flat_map*>(this)->find(key); }
+  bool contains(const K& key) const noexcept { return find_index(key, hash_of(key)) != capacity_; }
+
+  template <typename... Args> std::pair<iterator, bool> try_emplace(const K& key, Args&&... args)
+  {
+    size_t hash = hash_of(key);
+    size_t i = find_index(key, hash);
+    if (i != capacity_)
+      return {iterator(ctrl + i, ctrl + capacity_, slots + i), false};
+
+    i = prepare_insert(hash);
+    std::construct_at(slots + i, std::piecewise_construct, std::forward_as_tuple(key),
+                      std::forward_as_tuple(std::forward<Args>(args)...));
+    return {iterator(ctrl + i, ctrl + capacity_, slots + i), true};
+  }
+  std::pair<iterator, bool> insert(const value_type& value) { return try_emplace(value.first, value.second); }
+
+  V& operator[](const K& key) { return try_emplace(key).first->second; }
+
+  bool erase(const K& key) noexcept
+  {
+    size_t i = find_index(key, hash_of(key));
+    if (i == capacity_)
+      return false;
+    std::destroy_at(slots + i);
+    set_ctrl(i, detail::ctrl_deleted);
+    --size_;
+    return true;
+  }
+
+  void clear() noexcept
+  {
+    destroy_slots();
+    if (capacity_ != 0)
+      std::memset(ctrl, detail::ctrl_empty, capacity_ + cloned_bytes);
+    size_ = 0;
+    growth_left = max_load(capacity_);
+  }
+};
+} // namespace bump
@@ -41,6 +41,10 @@ struct StringBuilder
       return iterator.string_view();
     }
     char* str = static_cast<char*>(allocator.allocateUnaligned(iterator.copy().count_bytes()));
+    if (str == nullptr)
+    {
+      return {}; //sealed arena
+    }
     char* dst = str;
 
     if (auto it = iterator.copy())do
@@ -86,10 +90,17 @@ public:
     char* buf = reinterpret_cast<char*>(allocator.end());
 
     //char* buf = static_cast<char*>(allocator.allocateUnaligned(size));
-    size_t true_size = allocator.remainingBytes() - hasTerminator;
+    //a full block (sealed, or a mapped file) has no room, not even for the terminator
+    size_t remaining = allocator.remainingBytes();
+    size_t true_size = remaining > static_cast<size_t>(hasTerminator) ? remaining - hasTerminator : 0;
 
     auto result = std::format_to_n(buf, true_size, fmt, std::forward<Args>(args)...);
+    allocator.mark_written(reinterpret_cast<std::byte*>(result.out));
     buf = static_cast<char*>(allocator.allocateUnaligned(result.size + hasTerminator));
+    if (buf == nullptr)
+    {
+      return {}; //sealed arena
+    }
 
     if (result.size > true_size)
     {
@@ -127,6 +138,10 @@ public:
     assert(last_append == allocator.end());
 
     char* buf = static_cast<char*>(allocator.allocateUnaligned(str.size()));
+    if (buf == nullptr)
+    {
+      return; //sealed arena
+    }
     std::copy_n(str.data(), str.size(), buf);
 
     last_append = allocator.end();
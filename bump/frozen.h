@@ -0,0 +1,128 @@
+#pragma once
+#include "bump/bump.h"
+
+#include <atomic>
+#include <utility>
+
+namespace bump
+{
+namespace detail
+{
+//shared by every handle of one frozen arena, the last one to go destroys it
+struct frozen_state
+{
+  std::atomic<size_t> references = 1;
+  void (*destroy)(frozen_state* self) noexcept = nullptr;
+};
+
+//mprotects the whole pages of the blocks up to the current one read-only (or writable again),
+//the partial pages at the block edges stay writable, they may be shared with other allocations
+void protect_blocks(BumpAllocator& arena, bool read_only) noexcept;
+} // namespace detail
+
+//read-only handle on the contents of a frozen arena, copies can be passed to any thread.
+//The memory is released when the last copy is gone
+template<typename T>
+class frozen
+{
+  template<size_t>
+  friend class freezable;
+
+  detail::frozen_state* state = nullptr;
+  const T* value = nullptr;
+
+  frozen(detail::frozen_state* state, const T* value) noexcept : state(state), value(value) {}
+
+public:
+  frozen() noexcept = default;
+  frozen(const frozen& other) noexcept : state(other.state), value(other.value)
+  {
+    if (state)
+    {
+      state->references.fetch_add(1, std::memory_order_relaxed);
+    }
+  }
+  frozen(frozen&& other) noexcept
+    : state(std::exchange(other.state, nullptr)), value(std::exchange(other.value, nullptr))
+  {
+  }
+  frozen& operator=(frozen other) noexcept
+  {
+    std::swap(state, other.state);
+    std::swap(value, other.value);
+    return *this;
+  }
+  ~frozen() noexcept
+  {
+    if (state && state->references.fetch_sub(1, std::memory_order_acq_rel) == 1)
+    {
+      state->destroy(state);
+    }
+  }
+
+  const T* get() const noexcept { return value; }
+  const T& operator*() const noexcept { return *value; }
+  const T* operator->() const noexcept { return value; }
+  explicit operator bool() const noexcept { return value != nullptr; }
+};
+
+//arena for data that is built once and then only read. It lives on the heap, so its frozen
+//handles can keep every block alive (the stack block too) after the builder is gone
+template<size_t stack_bytes = 4096>
+class freezable
+{
+  struct state : detail::frozen_state
+  {
+    allocator<stack_bytes> arena;
+    bool read_only = false;
+  };
+  state* shared;
+
+  static void destroy(detail::frozen_state* base) noexcept
+  {
+    auto* self = static_cast<state*>(base);
+    if (self->read_only)
+    {
+      detail::protect_blocks(self->arena, false);
+    }
+    delete self;
+  }
+
+public:
+  freezable() : shared(new state)
+  {
+    shared->destroy = destroy;
+  }
+  ~freezable()
+  {
+    if (shared)
+    {
+      destroy(shared);
+    }
+  }
+  freezable(const freezable&) = delete;
+  freezable& operator=(const freezable&) = delete;
+
+  BumpAllocator& arena() noexcept
+  {
+    assert(shared);
+    return shared->arena;
+  }
+
+  //seals the arena and hands it to the returned handle, `root` is what readers get from it.
+  //`read_only` mprotects the blocks, so a stray write faults instead of racing with readers
+  template<typename T>
+  frozen<T> freeze(const T* root, bool read_only = false) &&
+  {
+    assert(shared);
+    BumpAllocator& sealed = shared->arena;
+    sealed.seal();
+    if (read_only)
+    {
+      detail::protect_blocks(sealed, true);
+      shared->read_only = true;
+    }
+    return {std::exchange(shared, nullptr), root};
+  }
+};
+} // namespace bump
@@ -0,0 +1,113 @@
+#pragma once
+#include <algorithm>
+#include <array>
+#include <atomic>
+#include <bit>
+#include <cstddef>
+#include <cstdint>
+
+namespace bump
+{
+//log-linear histogram with 3 significant bits (<= 12.5% error), meant for nanosecond latencies
+class latency_histogram
+{
+  static constexpr size_t sub_bits = 3;
+  static constexpr size_t sub_buckets = size_t{1} << sub_bits;
+  static constexpr size_t max_exponent = 40; //values above ~18 minutes land in the last bucket
+  static constexpr size_t bucket_count = (max_exponent - sub_bits + 2) * sub_buckets;
+
+  std::array<uint32_t, bucket_count> counts{};
+  uint64_t total = 0;
+  uint64_t max_value = 0;
+
+  static size_t index_of(uint64_t value) noexcept
+  {
+    value = std::min(value, (uint64_t{1} << (max_exponent + 1)) - 1);
+    if (value < sub_buckets)
+    {
+      return value;
+    }
+    size_t exponent = std::bit_width(value) - 1;
+    size_t sub = (value >> (exponent - sub_bits)) & (sub_buckets - 1);
+    return (exponent - sub_bits + 1) * sub_buckets + sub;
+  }
+  static uint64_t upper_bound(size_t index) noexcept
+  {
+    if (index < sub_buckets)
+    {
+      return index;
+    }
+    size_t exponent = index / sub_buckets + sub_bits - 1;
+    uint64_t lower = (sub_buckets + index % sub_buckets) << (exponent - sub_bits);
+    return lower + (uint64_t{1} << (exponent - sub_bits)) - 1;
+  }
+
+public:
+  void record(uint64_t value) noexcept
+  {
+    ++counts[index_of(value)];
+    ++total;
+    max_value = std::max(max_value, value);
+  }
+
+  //record() for a histogram that other threads snapshot() meanwhile: one writer, relaxed stores,
+  //a snapshot may be a few samples behind but never reads a torn counter
+  void record_shared(uint64_t value) noexcept
+  {
+    auto& bucket = counts[index_of(value)];
+    std::atomic_ref(bucket).store(bucket + 1, std::memory_order_relaxed);
+    std::atomic_ref(total).store(total + 1, std::memory_order_relaxed);
+    if (value > max_value)
+    {
+      std::atomic_ref(max_value).store(value, std::memory_order_relaxed);
+    }
+  }
+  latency_histogram snapshot() noexcept
+  {
+    latency_histogram copy;
+    for (size_t i = 0; i < bucket_count; ++i)
+    {
+      copy.counts[i] = std::atomic_ref(counts[i]).load(std::memory_order_relaxed);
+    }
+    copy.total = std::atomic_ref(total).load(std::memory_order_relaxed);
+    copy.max_value = std::atomic_ref(max_value).load(std::memory_order_relaxed);
+    return copy;
+  }
+
+  uint64_t count() const noexcept { return total; }
+  uint64_t max() const noexcept { return max_value; }
+
+  //smallest bucket bound with at least `percent` of the samples at or below it
+  uint64_t percentile(double percent) const noexcept
+  {
+    if (total == 0)
+    {
+      return 0;
+    }
+    auto target = static_cast<uint64_t>(percent / 100.0 * static_cast<double>(total) + 0.5);
+    target = std::clamp<uint64_t>(target, 1, total);
+    uint64_t seen = 0;
+    for (size_t i = 0; i < bucket_count; ++i)
+    {
+      seen += counts[i];
+      if (seen >= target)
+      {
+        return std::min(upper_bound(i), max_value);
+      }
+    }
+    return max_value;
+  }
+
+  void merge(const latency_histogram& other) noexcept
+  {
+    for (size_t i = 0; i < bucket_count; ++i)
+    {
+      counts[i] += other.counts[i];
+    }
+    total += other.total;
+    max_value = std::max(max_value, other.max_value);
+  }
+
+  bool operator==(const latency_histogram&) const = default;
+};
+} // namespace bump
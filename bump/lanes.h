@@ -0,0 +1,95 @@
+#pragma once
+#include "bump/bump.h"
+
+#include <array>
+#include <type_traits>
+#include <utility>
+
+namespace bump
+{
+//arena split into lanes that bump through their own block chains, so hot objects stay packed
+//together instead of sharing cache lines and pages with cold ones. All lanes share one Frame
+template<size_t Lanes, size_t stack_bytes = 1024>
+class lanes
+{
+  static_assert(Lanes > 0);
+  std::array<allocator<stack_bytes>, Lanes> arenas;
+
+  template<typename Lane>
+  static size_t index(Lane lane) noexcept
+  {
+    if constexpr (std::is_enum_v<Lane>)
+    {
+      return static_cast<size_t>(std::to_underlying(lane));
+    }
+    else
+    {
+      return static_cast<size_t>(lane);
+    }
+  }
+
+public:
+  struct Frame
+  {
+    std::array<BumpAllocator::Frame, Lanes> lanes;
+  };
+
+  //restores the frame of every lane when the scope ends
+  class Guard
+  {
+    lanes& arena;
+    const Frame frame;
+
+  public:
+    explicit Guard(lanes& arena) noexcept : arena(arena), frame(arena.getFrame()) {}
+    ~Guard() noexcept { arena.restoreFrame(frame); }
+    Guard(const Guard&) = delete;
+    Guard& operator=(const Guard&) = delete;
+  };
+
+  //lane is an index or an enum, e.g. `enum class lane { hot, cold };`
+  template<typename Lane>
+  BumpAllocator& lane(Lane lane) noexcept
+  {
+    assert(index(lane) < Lanes);
+    return arenas[index(lane)];
+  }
+
+  template<typename Lane>
+  void* allocate(Lane lane, size_t bytes, size_t align = sizeof(size_t)) noexcept
+  {
+    return this->lane(lane).allocate(bytes, align);
+  }
+  template<typename T, typename Lane>
+  T* push(Lane lane) noexcept
+  {
+    return this->lane(lane).template push<T>();
+  }
+
+  Frame getFrame() noexcept
+  {
+    Frame frame;
+    for (size_t i = 0; i < Lanes; ++i)
+    {
+      frame.lanes[i] = lane(i).getFrame();
+    }
+    return frame;
+  }
+  void restoreFrame(const Frame& frame) noexcept
+  {
+    for (size_t i = 0; i < Lanes; ++i)
+    {
+      lane(i).restoreFrame(frame.lanes[i]);
+    }
+  }
+
+  //names every lane of the arena for HeapTracker
+  void SetName(const char* name)
+  {
+    for (size_t i = 0; i < Lanes; ++i)
+    {
+      lane(i).SetName(name);
+    }
+  }
+};
+} // namespace bump
@@ -0,0 +1,28 @@
+#pragma once
+#include <cstddef>
+
+namespace bump::numa
+{
+static constexpr int none = -1; //blocks come from std::allocator
+static constexpr int local = -2; //node of the thread that grows the arena
+
+struct block
+{
+  void* ptr;
+  size_t size;
+  int node;
+  bool zeroed = false; //freshly mapped, not recycled from the pool
+};
+
+//1 on machines without NUMA (or without support for it), the fallback paths are taken then
+unsigned node_count() noexcept;
+int current_node() noexcept;
+
+//page aligned block placed on `node` (or the calling thread's node for numa::local),
+//recycled from the node's pool if possible. ptr is nullptr if the system is out of memory
+block allocate(size_t bytes, int node) noexcept;
+//gives the block back to its node's pool, unmaps it once the pool is full
+void release(const block& block) noexcept;
+//unmaps the pooled blocks of every node, the next blocks are fresh (zero) mappings again
+void drain() noexcept;
+} // namespace bump::numa
@@ -0,0 +1,76 @@
+#pragma once
+#include <cstddef>
+#include <cstdint>
+#include <type_traits>
+
+namespace bump
+{
+//pointer stored as the distance to its own address, stays valid when the whole
+//region it lives in is copied or mapped to another base address
+template <typename T> class offset_ptr
+{
+  static constexpr std::ptrdiff_t null_offset = 1; //never a valid distance to a T from here
+
+  std::ptrdiff_t offset = null_offset;
+
+  void set(T* ptr) noexcept
+  {
+    offset = ptr ? reinterpret_cast<std::intptr_t>(ptr) - reinterpret_cast<std::intptr_t>(this)
+                 : null_offset;
+  }
+
+public:
+  using element_type = T;
+
+  offset_ptr() noexcept = default;
+  offset_ptr(std::nullptr_t) noexcept {}
+  offset_ptr(T* ptr) noexcept { set(ptr); }
+  offset_ptr(const offset_ptr& other) noexcept { set(other.get()); }
+  template <typename U>
+  requires std::is_convertible_v<U*, T*>
+  offset_ptr(const offset_ptr<U>& other) noexcept
+  {
+    set(other.get());
+  }
+
+  offset_ptr& operator=(const offset_ptr& other) noexcept
+  {
+    set(other.get());
+    return *this;
+  }
+  offset_ptr& operator=(T* ptr) noexcept
+  {
+    set(ptr);
+    return *this;
+  }
+
+  T* get() const noexcept
+  {
+    if (offset == null_offset)
+    {
+      return nullptr;
+    }
+    return reinterpret_cast<T*>(reinterpret_cast<std::intptr_t>(this) + offset);
+  }
+
+  T* operator->() const noexcept { return get(); }
+  template <typename U = T>
+  requires (!std::is_void_v<U>)
+  U& operator*() const noexcept
+  {
+    return *get();
+  }
+  template <typename U = T>
+  requires (!std::is_void_v<U>)
+  U& operator[](size_t i) const noexcept
+  {
+    return get()[i];
+  }
+
+  explicit operator bool() const noexcept { return offset != null_offset; }
+  operator T*() const noexcept { return get(); }
+
+  bool operator==(const offset_ptr& other) const noexcept { return get() == other.get(); }
+  bool operator==(std::nullptr_t) const noexcept { return offset == null_offset; }
+};
+} // namespace bump
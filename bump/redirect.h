@@ -0,0 +1,58 @@
+#pragma once
+#include "bump/bump.h"
+
+namespace bump
+{
+//sends global operator new (link bump_operator_new) and malloc (LD_PRELOAD libbump_malloc_shim)
+//of the current thread to a frame of `arena` until the scope ends. Scopes nest, the innermost
+//one gets the allocations. Frees of frame memory are ignored, so everything allocated inside has
+//to be dead when the scope ends and must not be freed by another thread
+class redirect_scope
+{
+  //blocks the scope's frame allocated from, sorted by address so frees find their scope quickly
+  struct range
+  {
+    const std::byte* begin;
+    const std::byte* end;
+  };
+
+  BumpGuard guard;
+  redirect_scope* previous;
+  std::vector<range> blocks;
+  Node* last_block;
+
+  void add_block(const std::byte* begin, Node* block);
+  bool contains(const std::byte* ptr) const noexcept;
+
+  friend struct redirect;
+
+public:
+  explicit redirect_scope(BumpAllocator& arena) noexcept;
+  ~redirect_scope() noexcept;
+
+  redirect_scope(const redirect_scope&) = delete;
+  redirect_scope& operator=(const redirect_scope&) = delete;
+};
+
+//hooks the replacement operators and the malloc shim call into
+struct redirect
+{
+  //nullptr outside of a scope, the caller falls back to the system allocator then
+  static void* allocate(size_t bytes, size_t align) noexcept;
+  //true if `ptr` is memory of an active frame (the free is ignored), false for foreign pointers
+  static bool release(void* ptr) noexcept;
+  //requested size of frame memory, SIZE_MAX for foreign pointers
+  static size_t size_of(const void* ptr) noexcept;
+
+private:
+  static redirect_scope* owner(const void* ptr) noexcept;
+};
+} // namespace bump
+
+//C entry points for the malloc shim, which binds to them weakly at load time
+extern "C"
+{
+void* bump_redirect_allocate(size_t bytes, size_t align) noexcept;
+bool bump_redirect_release(void* ptr) noexcept;
+size_t bump_redirect_size(const void* ptr) noexcept;
+}
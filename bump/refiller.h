@@ -0,0 +1,46 @@
+#pragma once
+#include "bump/bump.h"
+
+#include <condition_variable>
+#include <mutex>
+#include <stop_token>
+#include <thread>
+#include <vector>
+
+namespace bump
+{
+//ready block the background refiller keeps for one arena
+struct refill_slot
+{
+  std::atomic<Node*> spare = nullptr;
+  std::atomic<size_t> capacity;
+  const int numa_node;
+
+  refill_slot(size_t capacity, int numa_node) noexcept : capacity(capacity), numa_node(numa_node) {}
+  ~refill_slot();
+
+  //hands out the spare if it is big enough and asks for the next one, nullptr otherwise
+  Node* take(size_t capacity) noexcept;
+};
+
+//single background thread that allocates and faults in the next block of registered arenas
+class refiller
+{
+  std::mutex mutex;
+  std::condition_variable_any wake;
+  std::vector<refill_slot*> slots;
+  bool pending = false;
+  std::jthread worker;
+
+  refiller();
+  void run(std::stop_token stop);
+
+public:
+  static refiller& instance();
+
+  void add(refill_slot* slot);
+  //after remove returns the refiller no longer touches the slot
+  void remove(refill_slot* slot);
+  void notify() noexcept;
+};
+} // namespace bump
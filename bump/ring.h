@@ -0,0 +1,148 @@
+#pragma once
+#include <cassert>
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+#include <span>
+
+namespace bump
+{
+//circular arena for FIFO lifetimes: allocations advance the head, pop() releases the oldest
+//message from the tail. Without a mirror a message that would run over the end leaves the rest
+//as a skipped fragment and starts at the front again; mirrored rings map the buffer twice back to
+//back, so a wrapped message stays contiguous. Not thread safe, one producer and one consumer on
+//different threads need their own synchronisation
+class ring
+{
+  //precedes every message, skipped fragments (wrap-around, alignment padding) have no size
+  struct header
+  {
+    uint32_t span; //bytes up to the next header
+    uint32_t size;
+  };
+  static constexpr uint32_t skipped = ~uint32_t{0};
+  static constexpr size_t granule = sizeof(header);
+
+  std::byte* base = nullptr;
+  size_t capacity_ = 0; //power of two, a whole number of pages
+  size_t mapped = 0;
+  uint64_t head = 0; //both only ever grow, the position is offset & (capacity_ - 1)
+  uint64_t tail = 0;
+  bool mirrored_ = false;
+
+  //header stores may alias the members as far as the compiler knows, so the hot paths keep head
+  //and tail in locals and write them back once
+  std::byte* at(uint64_t offset) const noexcept
+  {
+    return base + (offset & (capacity_ - 1));
+  }
+  static void write(std::byte* where, header h) noexcept
+  {
+    std::memcpy(where, &h, sizeof(h));
+  }
+  header read(uint64_t offset) const noexcept
+  {
+    header h;
+    std::memcpy(&h, at(offset), sizeof(h));
+    return h;
+  }
+  //tail moved past skipped fragments
+  uint64_t live_tail() const noexcept
+  {
+    uint64_t live = tail;
+    for (header h; live != head && (h = read(live)).size == skipped;)
+    {
+      live += h.span;
+    }
+    return live;
+  }
+
+public:
+  //capacity is rounded up to a power of two pages, at most 2 GiB. `mirrored` falls back to a
+  //plain mapping if the system has no memfd, mirrored() tells which one it got
+  explicit ring(size_t capacity, bool mirrored = false) noexcept;
+  ~ring() noexcept;
+
+  ring(const ring&) = delete;
+  ring& operator=(const ring&) = delete;
+
+  //nullptr if the message does not fit until older ones are popped.
+  //align has to be a power of two no bigger than a page
+  void* allocate(size_t bytes, size_t align = alignof(std::max_align_t)) noexcept
+  {
+    assert((align & (align - 1)) == 0);
+    align = align < granule ? granule : align;
+    size_t body = (bytes + granule - 1) & ~(granule - 1);
+    if (body + sizeof(header) > capacity_)
+    {
+      return nullptr;
+    }
+    uint64_t start = head;
+    uint64_t end = tail;
+    if (start == end)
+    {
+      start = end = tail = 0; //an empty ring starts over at the front, nothing has to be skipped
+    }
+    size_t free = capacity_ - (start - end);
+    size_t position = start & (capacity_ - 1);
+    size_t pad = ((position + sizeof(header) + align - 1) & ~(align - 1)) - sizeof(header);
+    pad -= position; //a multiple of granule, big enough for the header of the skipped fragment
+    size_t wrap = 0;
+    if (!mirrored_ && position + pad + sizeof(header) + body > capacity_)
+    {
+      wrap = capacity_ - position;
+      pad = ((sizeof(header) + align - 1) & ~(align - 1)) - sizeof(header);
+    }
+    size_t span = sizeof(header) + body;
+    if (wrap + pad + span > free)
+    {
+      return nullptr;
+    }
+    if (wrap)
+    {
+      write(at(start), {static_cast<uint32_t>(wrap), skipped});
+      start += wrap;
+    }
+    if (pad)
+    {
+      write(at(start), {static_cast<uint32_t>(pad), skipped});
+      start += pad;
+    }
+    std::byte* message = at(start);
+    head = start + span;
+    write(message, {static_cast<uint32_t>(span), static_cast<uint32_t>(bytes)});
+    return message + sizeof(header);
+  }
+  template<typename T>
+  T* push() noexcept
+  {
+    return static_cast<T*>(allocate(sizeof(T), alignof(T)));
+  }
+
+  //oldest live message, empty if there is none
+  std::span<std::byte> front() const noexcept
+  {
+    uint64_t live = live_tail();
+    if (live == head)
+    {
+      return {};
+    }
+    return {at(live) + sizeof(header), read(live).size};
+  }
+  //releases the oldest message and the fragments in front of it
+  void pop() noexcept
+  {
+    uint64_t live = live_tail();
+    assert(live != head);
+    tail = live + read(live).span;
+  }
+
+  bool empty() const noexcept { return live_tail() == head; }
+  //bytes between tail and head, headers and skipped fragments included
+  size_t used() const noexcept { return head - tail; }
+  size_t capacity() const noexcept { return capacity_; }
+  bool mirrored() const noexcept { return mirrored_; }
+  //false if the memory could not be mapped, every allocation fails then
+  explicit operator bool() const noexcept { return base != nullptr; }
+};
+} // namespace bump
@@ -0,0 +1,136 @@
+#pragma once
+#include "bump/bump.h"
+
+#include <atomic>
+#include <deque>
+#include <memory>
+#include <mutex>
+#include <new>
+#include <thread>
+#include <type_traits>
+#include <utility>
+#include <vector>
+
+namespace bump
+{
+class task_group;
+
+//queued call, lives in the group's arena until the group is destroyed
+struct task
+{
+  void (*invoke)(task& self, BumpGuard& frame);
+  task_group* group;
+};
+
+//fork-join scheduler: every worker owns an arena and runs each task in its own BumpGuard frame
+//on it, stolen tasks included. Waiting workers run queued tasks meanwhile, so their frames nest
+class scheduler
+{
+  struct worker
+  {
+    scheduler* owner;
+    std::mutex mutex;
+    std::deque<task*> tasks; //owner works at the back, thieves take from the front
+    allocator<16 * 1024> arena;
+  };
+
+  std::vector<std::unique_ptr<worker>> workers;
+  std::vector<std::jthread> threads;
+  std::mutex inject_mutex;
+  std::deque<task*> injected; //tasks spawned by threads outside of the scheduler
+  std::atomic<size_t> queued = 0;
+  std::atomic<bool> stop = false;
+
+  static thread_local worker* current;
+
+  task* pop(worker& self) noexcept;
+  task* steal(size_t first) noexcept;
+  task* find(worker* self) noexcept;
+  void execute(worker& self, task& next) noexcept;
+  void work(worker& self) noexcept;
+
+  friend class task_group;
+  void push(task* next);
+  //runs queued tasks until `done` returns true, blocks outside of worker threads
+  template<typename Done>
+  void help(Done&& done, const std::atomic<size_t>& pending);
+
+public:
+  explicit scheduler(unsigned threads = std::thread::hardware_concurrency());
+  ~scheduler();
+
+  scheduler(const scheduler&) = delete;
+  scheduler& operator=(const scheduler&) = delete;
+
+  unsigned size() const noexcept { return static_cast<unsigned>(workers.size()); }
+  //arena of the calling worker thread, nullptr outside of the scheduler
+  static BumpAllocator* worker_arena() noexcept;
+};
+
+//tasks spawned together and waited for together. Task memory is gone when the task returns,
+//anything that has to outlive it is copied into the group's result arena with keep()
+class task_group
+{
+  friend class scheduler;
+  scheduler& pool;
+  std::atomic<size_t> pending = 0;
+  std::mutex mutex; //guards results, tasks of the group share it
+  std::mutex finish_mutex; //held by the last finished() until its notify is done
+  allocator<1024> results;
+
+  void finished() noexcept;
+
+public:
+  //`upstream` backs the result arena, e.g. a frame of the arena of the code creating the group
+  explicit task_group(scheduler& pool, std::pmr::memory_resource* upstream = nullptr)
+    : pool(pool), results(upstream)
+  {
+  }
+  ~task_group() { wait(); }
+
+  task_group(const task_group&) = delete;
+  task_group& operator=(const task_group&) = delete;
+
+  //queues func(BumpGuard& frame), the frame is on the arena of the worker running it
+  template<typename Func>
+  void run(Func&& func)
+  {
+    using closure = std::decay_t<Func>;
+    struct spawned : task
+    {
+      closure func;
+    };
+    auto invoke = [](task& self, BumpGuard& frame)
+    {
+      auto& call = static_cast<spawned&>(self);
+      call.func(frame);
+      std::destroy_at(&call.func);
+    };
+    void* memory;
+    {
+      std::lock_guard lock(mutex);
+      memory = results->allocate(sizeof(spawned), alignof(spawned));
+    }
+    if (memory == nullptr)
+    {
+      throw std::bad_alloc(); //the upstream of the result arena is out of memory
+    }
+    auto* next = new (memory) spawned{{invoke, this}, std::forward<Func>(func)};
+    pending.fetch_add(1, std::memory_order_relaxed);
+    pool.push(next);
+  }
+
+  //returns once every task of the group finished, running other tasks meanwhile. The group may
+  //be destroyed right after, no worker touches it anymore
+  void wait();
+
+  //copies `bytes` out of a task frame into memory that lives as long as the group
+  void* keep(const void* data, size_t bytes, size_t align = alignof(std::max_align_t));
+  template<typename T>
+  T* keep(const T& value)
+  {
+    static_assert(std::is_trivially_copyable_v<T>, "kept results are copied bytewise");
+    return static_cast<T*>(keep(&value, sizeof(T), alignof(T)));
+  }
+};
+} // namespace bump
@@ -0,0 +1,37 @@
+#pragma once
+#include "bump/bump.h"
+
+#include <utility>
+
+namespace bump
+{
+namespace detail
+{
+inline thread_local BumpAllocator* current_arena = nullptr;
+}
+
+//makes an arena the thread's current one until the scope ends, scopes nest
+class scoped_arena
+{
+  BumpAllocator* previous;
+
+public:
+  explicit scoped_arena(BumpAllocator& arena) noexcept
+    : previous(std::exchange(detail::current_arena, &arena))
+  {
+  }
+  ~scoped_arena() noexcept
+  {
+    detail::current_arena = previous;
+  }
+
+  //nullptr outside of any scope
+  static BumpAllocator* current() noexcept
+  {
+    return detail::current_arena;
+  }
+
+  scoped_arena(const scoped_arena&) = delete;
+  scoped_arena& operator=(const scoped_arena&) = delete;
+};
+} // namespace bump
@@ -0,0 +1,39 @@
+#pragma once
+#include "bump/bump.h"
+#include "bump/offset_ptr.h"
+
+#include <cstdint>
+
+namespace bump
+{
+//file layout: [SnapshotHeader][image], the image is the byte range of one frame.
+//everything inside has to point through offset_ptr, so the image works at any base address.
+struct alignas(64) SnapshotHeader
+{
+  static constexpr uint64_t MAGIC = 0x746f6e7370616d62; //"bmapsnot"
+  static constexpr uint32_t VERSION = 1;
+
+  uint64_t magic = MAGIC;
+  uint32_t version = VERSION;
+  uint32_t pointer_size = sizeof(void*);
+  uint64_t size = 0;
+  uint64_t root = 0;
+};
+
+static constexpr size_t snapshot_alignment = alignof(SnapshotHeader);
+
+//reserves one contiguous block for a snapshot image and returns the frame it starts at
+BumpAllocator::Frame begin_snapshot(BumpAllocator& allocator, size_t capacity) noexcept;
+
+//writes everything allocated since `begin` to path, fails if the image spans more than one block
+bool write_snapshot(const char* path, BumpAllocator& allocator, const BumpAllocator::Frame& begin,
+                    const void* root) noexcept;
+
+//maps the image read-only into the current frame, returns nullptr for missing or foreign files
+const void* load_snapshot(BumpAllocator& allocator, const char* path) noexcept;
+
+template <typename T> const T* load_snapshot(BumpAllocator& allocator, const char* path) noexcept
+{
+  return static_cast<const T*>(load_snapshot(allocator, path));
+}
+} // namespace bump
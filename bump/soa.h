@@ -0,0 +1,173 @@
+#pragma once
+#include "bump/bump.h"
+
+#include <algorithm>
+#include <array>
+#include <cstring>
+#include <memory>
+#include <new>
+#include <span>
+#include <tuple>
+#include <type_traits>
+#include <utility>
+
+namespace bump
+{
+//struct-of-arrays container: every field gets its own contiguous, 64-byte aligned column, all
+//columns share one arena allocation. Nothing is destroyed, the columns go away with the frame.
+//Growing on a sealed or exhausted arena throws std::bad_alloc and leaves the columns as they are
+template<typename... Ts>
+class soa
+{
+  static constexpr size_t column_align = 64;
+  static constexpr size_t columns = sizeof...(Ts);
+  static constexpr std::array<size_t, columns> widths = {sizeof(Ts)...};
+
+  static_assert(columns > 0);
+  static_assert((std::is_trivially_copyable_v<Ts> && ...), "columns are moved with memmove");
+  static_assert(((alignof(Ts) <= column_align) && ...));
+
+  BumpAllocator* allocator;
+  std::array<std::byte*, columns> starts{};
+  size_t size_ = 0;
+  size_t capacity_ = 0;
+
+  template<size_t I>
+  using nth = std::tuple_element_t<I, std::tuple<Ts...>>;
+
+  //byte offset of every column for a capacity, the last entry is the size of the allocation
+  static std::array<size_t, columns + 1> layout(size_t capacity) noexcept
+  {
+    std::array<size_t, columns + 1> offsets{};
+    for (size_t i = 0; i < columns; ++i)
+    {
+      size_t bytes = capacity * widths[i];
+      offsets[i + 1] = offsets[i] + ((bytes + column_align - 1) & ~(column_align - 1));
+    }
+    return offsets;
+  }
+
+  template<size_t I>
+  nth<I>* at() const noexcept
+  {
+    return reinterpret_cast<nth<I>*>(starts[I]);
+  }
+
+  void grow(size_t capacity)
+  {
+    auto old_offsets = layout(capacity_);
+    auto offsets = layout(capacity);
+    std::byte* data = starts[0];
+    if (data && allocator->try_extend(data, old_offsets[columns], offsets[columns]))
+    {
+      //columns only move up, going back to front never overwrites one that still has to move
+      for (size_t i = columns; i-- > 1;)
+      {
+        std::memmove(data + offsets[i], data + old_offsets[i], size_ * widths[i]);
+      }
+    }
+    else
+    {
+      data = static_cast<std::byte*>(allocator->allocate(offsets[columns], column_align));
+      if (data == nullptr)
+      {
+        throw std::bad_alloc();
+      }
+      for (size_t i = 0; i < columns && size_; ++i)
+      {
+        std::memcpy(data + offsets[i], starts[i], size_ * widths[i]);
+      }
+    }
+    for (size_t i = 0; i < columns; ++i)
+    {
+      starts[i] = data + offsets[i];
+    }
+    capacity_ = capacity;
+  }
+  void ensure(size_t count)
+  {
+    if (count > capacity_)
+    {
+      grow(std::max({count, capacity_ * 2, size_t{16}}));
+    }
+  }
+
+public:
+  explicit soa(BumpAllocator& allocator, size_t capacity = 0) : allocator(&allocator)
+  {
+    reserve(capacity);
+  }
+
+  soa(const soa&) = delete;
+  soa& operator=(const soa&) = delete;
+  soa(soa&& other) noexcept
+    : allocator(other.allocator), starts(std::exchange(other.starts, {})),
+      size_(std::exchange(other.size_, 0)), capacity_(std::exchange(other.capacity_, 0))
+  {
+  }
+
+  size_t size() const noexcept { return size_; }
+  size_t capacity() const noexcept { return capacity_; }
+  bool empty() const noexcept { return size_ == 0; }
+
+  void reserve(size_t capacity)
+  {
+    if (capacity > capacity_)
+    {
+      grow(capacity);
+    }
+  }
+
+  void push_back(const Ts&... values)
+  {
+    ensure(size_ + 1);
+    [&]<size_t... I>(std::index_sequence<I...>)
+    {
+      ((at<I>()[size_] = values), ...);
+    }(std::index_sequence_for<Ts...>{});
+    ++size_;
+  }
+
+  //bulk append, every column gets the same number of values
+  void append(std::span<const Ts>... values)
+  {
+    size_t count = std::get<0>(std::tie(values...)).size();
+    assert(((values.size() == count) && ...));
+    ensure(size_ + count);
+    [&]<size_t... I>(std::index_sequence<I...>)
+    {
+      (std::memcpy(at<I>() + size_, values.data(), count * sizeof(Ts)), ...);
+    }(std::index_sequence_for<Ts...>{});
+    size_ += count;
+  }
+
+  //new rows are value-initialized, ready to be filled column by column
+  void resize(size_t size)
+  {
+    ensure(size);
+    if (size > size_)
+    {
+      [&]<size_t... I>(std::index_sequence<I...>)
+      {
+        (std::uninitialized_value_construct_n(at<I>() + size_, size - size_), ...);
+      }(std::index_sequence_for<Ts...>{});
+    }
+    size_ = size;
+  }
+  void clear() noexcept
+  {
+    size_ = 0;
+  }
+
+  template<size_t I>
+  std::span<nth<I>> column() noexcept
+  {
+    return {at<I>(), size_};
+  }
+  template<size_t I>
+  std::span<const nth<I>> column() const noexcept
+  {
+    return {at<I>(), size_};
+  }
+};
+} // namespace bump
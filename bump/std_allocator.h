@@ -0,0 +1,73 @@
+#pragma once
+#include "bump/bump.h"
+#include "bump/scoped_arena.h"
+
+#include <limits>
+#include <new>
+
+namespace bump
+{
+//arena source of std_allocator: the thread's scoped_arena, which has to be set while the
+//container allocates. Allocating outside of any scope throws std::bad_alloc
+struct thread_arena
+{
+  static BumpAllocator& arena()
+  {
+    BumpAllocator* current = scoped_arena::current();
+    if (current == nullptr)
+    {
+      throw std::bad_alloc();
+    }
+    return *current;
+  }
+};
+
+//arena source bound at compile time to an object with static storage duration,
+//e.g. `static bump::allocator<> arena;` and `bound_arena<arena>`
+template<auto& Arena>
+struct bound_arena
+{
+  static BumpAllocator& arena() noexcept
+  {
+    return Arena;
+  }
+};
+
+//stateless standard allocator over an arena, no virtual call and no resource pointer per
+//container. deallocate is a no-op, the memory goes away with the arena's frame. A sealed or
+//exhausted arena makes allocate throw std::bad_alloc
+template<typename T, typename Source = thread_arena>
+struct std_allocator
+{
+  using value_type = T;
+
+  std_allocator() noexcept = default;
+  template<typename U>
+  std_allocator(const std_allocator<U, Source>&) noexcept
+  {
+  }
+
+  [[nodiscard]] T* allocate(size_t count)
+  {
+    if (count > std::numeric_limits<size_t>::max() / sizeof(T))
+    {
+      throw std::bad_array_new_length();
+    }
+    void* memory = Source::arena().allocate_inline(count * sizeof(T), alignof(T));
+    if (memory == nullptr)
+    {
+      throw std::bad_alloc();
+    }
+    return static_cast<T*>(memory);
+  }
+  void deallocate(T*, size_t) noexcept
+  {
+  }
+
+  template<typename U>
+  bool operator==(const std_allocator<U, Source>&) const noexcept
+  {
+    return true;
+  }
+};
+} // namespace bump
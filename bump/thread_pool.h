@@ -0,0 +1,44 @@
+#pragma once
+#include <atomic>
+#include <condition_variable>
+#include <cstdint>
+#include <functional>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+namespace bump
+{
+//fixed set of workers for fork-join loops, the calling thread helps until the loop is done
+class thread_pool
+{
+  std::vector<std::jthread> workers;
+  std::mutex submit;
+  std::mutex mutex;
+  std::condition_variable wake;
+  std::condition_variable finished;
+
+  const std::function<void(size_t)>* job = nullptr;
+  size_t jobs = 0;
+  std::atomic<size_t> next = 0;
+  size_t busy = 0;
+  uint64_t generation = 0;
+  bool stop = false;
+
+  void drain(const std::function<void(size_t)>& func, size_t count) noexcept;
+  void work() noexcept;
+
+public:
+  explicit thread_pool(unsigned threads = std::thread::hardware_concurrency());
+  ~thread_pool();
+
+  thread_pool(const thread_pool&) = delete;
+  thread_pool& operator=(const thread_pool&) = delete;
+
+  //number of threads running a loop, including the caller
+  unsigned size() const noexcept { return static_cast<unsigned>(workers.size()) + 1; }
+
+  //calls func(i) for every i < count, returns once all calls finished
+  void parallel_for(size_t count, const std::function<void(size_t)>& func);
+};
+} // namespace bump
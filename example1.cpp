@@ -5,7 +5,6 @@
 #include "bump/default_formatter.h"
 #include "bump/formatter.h"
 #include <format>
-#include <fstream>
 #include <iostream>
 #include <print>
 #include <vector>
@@ -194,24 +193,15 @@ int main(int args, char** argv)
   bump::allocator allocator;
   bump::frame_ptr ptr(allocator);
 
-  std::filesystem::path path(argv[1]);
-  auto length = std::filesystem::file_size(path);
-
-  std::pmr::vector<char> buffer(length + 1);
-
-  if(std::ifstream file = std::ifstream(path, std::ios::binary | std::ios::in))
-  {
-    file.read(buffer.data(), length);
-    file.close();
-  }
-  else
+  auto file = allocator->map_file(argv[1]);
+  if (!file)
   {
     std::println(stderr, "failed to open file: {}", argv[1]);
     return 2;
   }
-  buffer.push_back('\0');
 
-  std::println("{}", buffer.data());
+  bump::StringBuilder contents{*file, allocator};
+  std::println("{}", contents.string_view());
 
   return 0;
 
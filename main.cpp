@@ -1,8 +1,19 @@
-
-
+#include "benchmark.h"
+#include "bump/async_reader.h"
+#include "bump/bounded.h"
 #include "bump/default_formatter.h"
+#include "bump/flat_map.h"
 #include "bump/formatter.h"
+#include "bump/histogram.h"
+#include "bump/lanes.h"
+#include "bump/ring.h"
+#include "bump/scheduler.h"
+#include "bump/std_allocator.h"
 #include <iostream>
+#include <deque>
+#include <filesystem>
+#include <fstream>
+#include <map>
 
 #include <memory_resource>
 #include <random>
@@ -21,25 +32,14 @@ struct Trackable
 };
 
 
-template <typename Map, typename Func>
-[[gnu::noinline]]
-void benchmark(const std::string& name, Map& map, Func&& func, size_t runs)
-{
-  auto start = std::chrono::high_resolution_clock::now();
-  for (size_t i = 0; i < runs; ++i)
-  {
-    func(map);
-  }
-  auto end = std::chrono::high_resolution_clock::now();
-
-  auto duration_ms =
-      std::chrono::duration_cast<std::chrono::milliseconds>(end - start).count();
-
-  std::cout << name << " took " << duration_ms << " ms\n";
-}
-
 using pmr_map = std::pmr::unordered_map<size_t, size_t>;
 
+template<typename T>
+using typed = bump::std_allocator<T>;
+using typed_map = std::map<size_t, size_t, std::less<>, typed<std::pair<const size_t, size_t>>>;
+using typed_row = std::vector<size_t, typed<size_t>>;
+using typed_rows = std::vector<typed_row, typed<typed_row>>;
+
 std::vector<void*> warmup_heap(size_t max_chunk, size_t bytes_per_type, float percent_free)
 {
   std::mt19937 gen(std::random_device{}());
@@ -64,8 +64,6 @@ std::vector<void*> warmup_heap(size_t max_chunk, size_t bytes_per_type, float pe
 
 int main()
 {
-
-  return 0;
   {
     using namespace bump;
     allocator resource;
@@ -86,22 +84,397 @@ int main()
 
     std::vector<void*> allocations = warmup_heap(64*1024, 256*1024, 50.0f);
 
+    auto fill = [&](auto& map)
+    {
+      for (size_t i = 0; i < inserts; ++i)
+      {
+        map[i * 31] = i;
+      }
+      size_t hits = 0;
+      for (size_t i = 0; i < inserts * 2; ++i)
+      {
+        hits += map.contains(i * 31);
+      }
+      assert(hits == inserts);
+    };
+
     for (size_t i = 0; i < 100; ++i)
     {
-      std::unordered_map<std::string, size_t> stdmap;
-      benchmark("std unordered_map", stdmap, [&](std::unordered_map<std::string, size_t>& ages)
+      std::unordered_map<size_t, size_t> stdmap;
+      benchmark("std unordered_map", stdmap, fill, 1);
+
+      bump::allocator resource;
+      bump::frame_ptr frame(resource);
+      pmr_map map(&frame);
+      benchmark("pmr unordered_map", map, fill, 1);
+
+      bump::flat_map<size_t, size_t> flatmap(frame);
+      benchmark("bump flat_map", flatmap, fill, 1);
+    }
+
+    bump::allocator deep;
+    {
+      bump::frame_ptr grow(deep);
+      for (size_t i = 0; i < 400; ++i)
+      {
+        deep->allocate(256 * 1024);
+      }
+    }
+    benchmark("nested BumpGuards over 400 blocks", deep, [](auto& arena)
+    {
+      for (size_t i = 0; i < 100'000; ++i)
       {
-        for (size_t i = 0; i < inserts; ++i)
+        bump::frame_ptr outer(arena);
+        arena->allocate(64);
+        bump::frame_ptr inner(arena);
+        arena->allocate(64);
+      }
+    }, 10);
+
+    auto requests = [](bump::BumpAllocator& connection, bool nested)
+    {
+      for (size_t i = 0; i < 10'000; ++i)
+      {
+        bump::frame_ptr frame(connection);
+        bump::allocator<1024> request(nested ? &frame : nullptr);
+        for (size_t j = 0; j < 1024; ++j)
         {
-           ages[std::to_string(i)] = i;
+          request->allocate(64);
         }
-      }, 1
-      );
+      }
+    };
+    bump::allocator connection;
+    benchmark("request arenas from the heap", connection, [&](auto& arena)
+    {
+      requests(arena, false);
+    }, 10);
+    benchmark("request arenas nested in a connection arena", connection, [&](auto& arena)
+    {
+      requests(arena, true);
+    }, 10);
 
-      bump::allocator resource;
-      bump::frame_ptr frame(resource);
-      pmr::unordered_map<std::string_view, std::string_view> map(&frame);
+    auto build = [](auto& map, auto& rows)
+    {
+      for (size_t i = 0; i < inserts; ++i)
+      {
+        map[i * 31] = i;
+        rows.emplace_back().push_back(i);
+      }
+    };
+    bump::allocator containers;
+    benchmark("pmr map and vectors", containers, [&](auto& arena)
+    {
+      bump::frame_ptr frame(arena);
+      std::pmr::map<size_t, size_t> map(&frame);
+      std::pmr::vector<std::pmr::vector<size_t>> rows(&frame);
+      build(map, rows);
+    }, 100);
+    benchmark("std_allocator map and vectors", containers, [&](auto& arena)
+    {
+      bump::frame_ptr frame(arena);
+      bump::scoped_arena scope(arena);
+      typed_map map;
+      typed_rows rows;
+      build(map, rows);
+    }, 100);
+
+    auto bump_loop = [](auto& arena)
+    {
+      for (size_t run = 0; run < 1000; ++run)
+      {
+        auto frame = arena.getFrame();
+        for (size_t i = 0; i < 4000; ++i)
+        {
+          *static_cast<size_t*>(arena.allocate(16)) = i;
+        }
+        arena.restoreFrame(frame);
+      }
+    };
+    bump::allocator<64 * 1024> chained;
+    benchmark("BumpAllocator 16 byte allocations", static_cast<bump::BumpAllocator&>(chained),
+              bump_loop, 10);
+    bump::bounded<64 * 1024> fixed;
+    benchmark("bounded 16 byte allocations", fixed, bump_loop, 10);
+
+    struct tree_node
+    {
+      tree_node* left;
+      tree_node* right;
+      size_t key;
+      std::byte* payload;
+    };
+    auto build_tree = [](bump::BumpAllocator& nodes, bump::BumpAllocator& payloads)
+    {
+      std::mt19937_64 gen(42);
+      tree_node* root = nullptr;
+      for (size_t i = 0; i < 100'000; ++i)
+      {
+        auto* node = new (nodes.push<tree_node>()) tree_node{nullptr, nullptr, gen(), nullptr};
+        node->payload = static_cast<std::byte*>(payloads.allocate(192));
+        tree_node** slot = &root;
+        while (*slot)
+        {
+          slot = node->key < (*slot)->key ? &(*slot)->left : &(*slot)->right;
+        }
+        *slot = node;
+      }
+      return root;
+    };
+    auto walk_tree = [](tree_node* root)
+    {
+      size_t sum = 0;
+      std::vector<tree_node*> stack{root};
+      while (!stack.empty())
+      {
+        tree_node* node = stack.back();
+        stack.pop_back();
+        sum += node->key;
+        if (node->left) stack.push_back(node->left);
+        if (node->right) stack.push_back(node->right);
+      }
+      return sum;
+    };
+    volatile size_t tree_sum = 0;
+    bump::allocator mixed;
+    benchmark("tree walks, nodes mixed with payloads", mixed, [&](auto& arena)
+    {
+      bump::frame_ptr frame(arena);
+      tree_node* root = build_tree(arena, arena);
+      for (size_t i = 0; i < 20; ++i)
+      {
+        tree_sum = tree_sum + walk_tree(root);
+      }
+    }, 5);
+    enum class lane { hot, cold };
+    bump::lanes<2> laned;
+    benchmark("tree walks, nodes in their own lane", laned, [&](auto& arena)
+    {
+      bump::lanes<2>::Guard frame(arena);
+      tree_node* root = build_tree(arena.lane(lane::hot), arena.lane(lane::cold));
+      for (size_t i = 0; i < 20; ++i)
+      {
+        tree_sum = tree_sum + walk_tree(root);
+      }
+    }, 5);
+
+    //every task builds and walks its own tree, only the sum leaves the task
+    auto task_tree = [](auto&& make)
+    {
+      std::mt19937_64 gen(7);
+      tree_node* root = nullptr;
+      for (size_t i = 0; i < 10'000; ++i)
+      {
+        tree_node* node = make(tree_node{nullptr, nullptr, gen(), nullptr});
+        tree_node** slot = &root;
+        while (*slot)
+        {
+          slot = node->key < (*slot)->key ? &(*slot)->left : &(*slot)->right;
+        }
+        *slot = node;
+      }
+      return root;
+    };
+    bump::scheduler workers;
+    benchmark("parallel tree builds, malloc", workers, [&](auto& pool)
+    {
+      bump::task_group group(pool);
+      for (size_t i = 0; i < 64; ++i)
+      {
+        group.run([&](bump::BumpGuard&)
+        {
+          tree_node* root = task_tree([](tree_node node) { return new tree_node(node); });
+          group.keep(walk_tree(root));
+          std::vector<tree_node*> stack{root};
+          while (!stack.empty())
+          {
+            tree_node* node = stack.back();
+            stack.pop_back();
+            if (node->left) stack.push_back(node->left);
+            if (node->right) stack.push_back(node->right);
+            delete node;
+          }
+        });
+      }
+    }, 10);
+    benchmark("parallel tree builds, task frames", workers, [&](auto& pool)
+    {
+      bump::task_group group(pool);
+      for (size_t i = 0; i < 64; ++i)
+      {
+        group.run([&](bump::BumpGuard& frame)
+        {
+          tree_node* root = task_tree([&](tree_node node)
+          {
+            return new (frame.allocator.push<tree_node>()) tree_node(node);
+          });
+          group.keep(walk_tree(root));
+        });
+      }
+    }, 10);
+
+    //streaming: 256 messages in flight, released in arrival order. Latency is taken per batch of
+    //64 messages so reading the clock does not dominate
+    struct malloc_queue
+    {
+      std::deque<std::span<std::byte>> messages;
+      std::span<std::byte> push(size_t bytes)
+      {
+        return messages.emplace_back(static_cast<std::byte*>(std::malloc(bytes)), bytes);
+      }
+      std::span<std::byte> front()
+      {
+        return messages.empty() ? std::span<std::byte>{} : messages.front();
+      }
+      void pop()
+      {
+        std::free(messages.front().data());
+        messages.pop_front();
+      }
+    };
+    struct ring_queue
+    {
+      bump::ring ring;
+      std::span<std::byte> push(size_t bytes)
+      {
+        return {static_cast<std::byte*>(ring.allocate(bytes)), bytes};
+      }
+      std::span<std::byte> front() { return ring.front(); }
+      void pop() { ring.pop(); }
+    };
+    auto stream = [&](auto& queue, bump::latency_histogram& latency)
+    {
+      std::mt19937 gen(3);
+      size_t checksum = 0;
+      for (size_t batch = 0; batch < 20'000; ++batch)
+      {
+        auto start = std::chrono::steady_clock::now();
+        for (size_t i = 0; i < 64; ++i)
+        {
+          std::span<std::byte> message = queue.push(64 + gen() % 960);
+          std::memset(message.data(), static_cast<int>(i), message.size());
+          if (batch * 64 + i >= 256)
+          {
+            checksum += static_cast<size_t>(queue.front()[0]);
+            queue.pop();
+          }
+        }
+        auto ns = std::chrono::steady_clock::now() - start;
+        latency.record(std::chrono::duration_cast<std::chrono::nanoseconds>(ns).count());
+      }
+      while (!queue.front().empty())
+      {
+        queue.pop();
+      }
+      tree_sum = tree_sum + checksum;
+    };
+    malloc_queue mallocs;
+    ring_queue plain{bump::ring(1 << 20)};
+    ring_queue mirrored{bump::ring(1 << 20, true)};
+    bump::latency_histogram malloc_latency, ring_latency, mirrored_latency;
+    benchmark("FIFO messages, malloc queue", mallocs, [&](auto& queue)
+    {
+      stream(queue, malloc_latency);
+    }, 10);
+    benchmark("FIFO messages, ring", plain, [&](auto& queue)
+    {
+      stream(queue, ring_latency);
+    }, 10);
+    benchmark("FIFO messages, mirrored ring", mirrored, [&](auto& queue)
+    {
+      stream(queue, mirrored_latency);
+    }, 10);
+    for (auto [name, latency]: {std::pair{"malloc queue", &malloc_latency},
+                                {"ring", &ring_latency}, {"mirrored ring", &mirrored_latency}})
+    {
+      std::cout << std::format("{} ns per 64 messages: p50 {} p99 {} max {}\n", name,
+                               latency->percentile(50), latency->percentile(99), latency->max());
+    }
 
+    //sparse zero-initialized tables, 4 MiB with 16 slots written each: memset faults in all 1024
+    //pages of a table, allocate_zeroed on a fresh NUMA block only the written ones. Both start
+    //from a drained NUMA pool, recycled blocks would be faulted in (and need clearing) already
+    auto sparse_tables = [&](auto&& zeroed_table)
+    {
+      std::mt19937_64 gen(5);
+      size_t sum = 0;
+      for (size_t table = 0; table < 64; ++table)
+      {
+        auto* slots = static_cast<size_t*>(zeroed_table(4 << 20));
+        for (size_t i = 0; i < 16; ++i)
+        {
+          size_t slot = gen() % (512 * 1024);
+          slots[slot] += i;
+          sum += slots[slot];
+        }
+      }
+      tree_sum = tree_sum + sum;
+    };
+    int numa_arena = 0;
+    bump::numa::drain();
+    benchmark("sparse tables, allocate + memset", numa_arena, [&](int&)
+    {
+      bump::allocator tables;
+      tables->SetNumaNode(bump::numa::local);
+      sparse_tables([&](size_t bytes)
+      {
+        return std::memset(tables->allocate(bytes), 0, bytes);
+      });
+    }, 1);
+    bump::numa::drain();
+    benchmark("sparse tables, allocate_zeroed", numa_arena, [&](int&)
+    {
+      bump::allocator tables;
+      tables->SetNumaNode(bump::numa::local);
+      sparse_tables([&](size_t bytes)
+      {
+        return tables->allocate_zeroed(bytes);
+      });
+    }, 1);
+
+    //2000 small config-like files: an ifstream each with a copy into a string, against one
+    //batched pass into arena buffers
+    auto directory = std::filesystem::temp_directory_path() / "bump_async_reader";
+    std::filesystem::create_directories(directory);
+    std::vector<std::string> names;
+    for (size_t i = 0; i < 2'000; ++i)
+    {
+      names.push_back((directory / std::format("config_{}.txt", i)).string());
+      std::ofstream(names.back()) << std::string(256 + i % 4096, static_cast<char>('a' + i % 26));
+    }
+    std::vector<const char*> paths;
+    for (auto& name: names)
+    {
+      paths.push_back(name.c_str());
+    }
+    benchmark("2000 files, ifstream each", paths, [&](auto& list)
+    {
+      size_t bytes = 0;
+      for (const char* path: list)
+      {
+        std::ifstream in(path, std::ios::binary);
+        std::string contents{std::istreambuf_iterator<char>(in), {}};
+        bytes += contents.size();
+      }
+      tree_sum = tree_sum + bytes;
+    }, 10);
+    bump::allocator loaded;
+    for (bool uring: {true, false})
+    {
+      bump::async_reader reader(256, uring);
+      std::string name = reader.uses_io_uring() ? "2000 files, async_reader io_uring"
+                                                : "2000 files, async_reader thread_pool";
+      benchmark(name, loaded, [&](auto& arena)
+      {
+        bump::frame_ptr frame(arena);
+        size_t bytes = 0;
+        for (auto& file: reader.read(arena, paths))
+        {
+          bytes += file.data.size();
+        }
+        tree_sum = tree_sum + bytes;
+      }, 10);
     }
+    std::filesystem::remove_all(directory);
   }
+  perf::print_report();
 }
@@ -0,0 +1,129 @@
+//LD_PRELOAD malloc shim: inside a bump::redirect_scope of the host program malloc and friends
+//allocate from the scope's frame, everything else goes to glibc. The hooks are weak, so the shim
+//is harmless in programs without the bump library. Programs linking bump_allocator export them
+#include <cerrno>
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+#include <dlfcn.h>
+
+extern "C"
+{
+void* bump_redirect_allocate(size_t bytes, size_t align) noexcept __attribute__((weak));
+bool bump_redirect_release(void* ptr) noexcept __attribute__((weak));
+size_t bump_redirect_size(const void* ptr) noexcept __attribute__((weak));
+
+void* __libc_malloc(size_t bytes);
+void* __libc_calloc(size_t count, size_t bytes);
+void* __libc_realloc(void* ptr, size_t bytes);
+void* __libc_memalign(size_t align, size_t bytes);
+void __libc_free(void* ptr);
+}
+
+namespace
+{
+void* redirected(size_t bytes, size_t align) noexcept
+{
+  return bump_redirect_allocate ? bump_redirect_allocate(bytes, align) : nullptr;
+}
+
+void* aligned(size_t align, size_t bytes) noexcept
+{
+  if (void* ptr = redirected(bytes, align))
+  {
+    return ptr;
+  }
+  return __libc_memalign(align, bytes);
+}
+} // namespace
+
+extern "C"
+{
+void* malloc(size_t bytes) noexcept
+{
+  if (void* ptr = redirected(bytes, alignof(std::max_align_t)))
+  {
+    return ptr;
+  }
+  return __libc_malloc(bytes);
+}
+
+void* calloc(size_t count, size_t bytes) noexcept
+{
+  if (bytes && count > SIZE_MAX / bytes)
+  {
+    errno = ENOMEM;
+    return nullptr;
+  }
+  if (void* ptr = redirected(count * bytes, alignof(std::max_align_t)))
+  {
+    return std::memset(ptr, 0, count * bytes);
+  }
+  return __libc_calloc(count, bytes);
+}
+
+void free(void* ptr) noexcept
+{
+  if (ptr && !(bump_redirect_release && bump_redirect_release(ptr)))
+  {
+    __libc_free(ptr);
+  }
+}
+
+void* realloc(void* ptr, size_t bytes) noexcept
+{
+  size_t old = ptr && bump_redirect_size ? bump_redirect_size(ptr) : SIZE_MAX;
+  if (old == SIZE_MAX)
+  {
+    return __libc_realloc(ptr, bytes);
+  }
+  if (bytes <= old)
+  {
+    return ptr;
+  }
+  void* moved = malloc(bytes);
+  if (moved)
+  {
+    std::memcpy(moved, ptr, old);
+    free(ptr);
+  }
+  return moved;
+}
+
+void* memalign(size_t align, size_t bytes) noexcept
+{
+  return aligned(align, bytes);
+}
+
+void* aligned_alloc(size_t align, size_t bytes) noexcept
+{
+  return aligned(align, bytes);
+}
+
+int posix_memalign(void** out, size_t align, size_t bytes) noexcept
+{
+  if (align < sizeof(void*) || (align & (align - 1)) != 0)
+  {
+    return EINVAL;
+  }
+  void* ptr = aligned(align, bytes);
+  if (ptr == nullptr)
+  {
+    return ENOMEM;
+  }
+  *out = ptr;
+  return 0;
+}
+
+size_t malloc_usable_size(void* ptr) noexcept
+{
+  size_t size = ptr && bump_redirect_size ? bump_redirect_size(ptr) : SIZE_MAX;
+  if (size != SIZE_MAX)
+  {
+    return size;
+  }
+  using usable_size = size_t (*)(void*);
+  static auto next = reinterpret_cast<usable_size>(::dlsym(RTLD_NEXT, "malloc_usable_size"));
+  return next ? next(ptr) : 0;
+}
+}
@@ -0,0 +1,124 @@
+//replacement global operator new/delete, linked in through the bump_operator_new target.
+//inside a bump::redirect_scope allocations come from the scope's frame, malloc everywhere else
+#include "bump/redirect.h"
+
+#include <cstdlib>
+#include <new>
+
+using bump::redirect;
+
+namespace
+{
+//nullptr if both the scope's frame and the heap are out of memory
+void* allocate(std::size_t size, std::size_t align) noexcept
+{
+  if (void* ptr = redirect::allocate(size, align))
+  {
+    return ptr;
+  }
+  return align <= __STDCPP_DEFAULT_NEW_ALIGNMENT__
+           ? std::malloc(size ? size : 1)
+           : std::aligned_alloc(align, (size + align - 1) & ~(align - 1));
+}
+
+void* allocate_or_throw(std::size_t size, std::size_t align)
+{
+  if (void* ptr = allocate(size, align))
+  {
+    return ptr;
+  }
+  throw std::bad_alloc();
+}
+
+void release(void* ptr) noexcept
+{
+  if (ptr && !redirect::release(ptr))
+  {
+    std::free(ptr);
+  }
+}
+} // namespace
+
+//every form is replaced: runtimes that replace some of them (sanitizers) would otherwise pair
+//their own new with this delete
+void* operator new(std::size_t size)
+{
+  return allocate_or_throw(size, __STDCPP_DEFAULT_NEW_ALIGNMENT__);
+}
+void* operator new[](std::size_t size)
+{
+  return allocate_or_throw(size, __STDCPP_DEFAULT_NEW_ALIGNMENT__);
+}
+void* operator new(std::size_t size, std::align_val_t align)
+{
+  return allocate_or_throw(size, static_cast<std::size_t>(align));
+}
+void* operator new[](std::size_t size, std::align_val_t align)
+{
+  return allocate_or_throw(size, static_cast<std::size_t>(align));
+}
+void* operator new(std::size_t size, const std::nothrow_t&) noexcept
+{
+  return allocate(size, __STDCPP_DEFAULT_NEW_ALIGNMENT__);
+}
+void* operator new[](std::size_t size, const std::nothrow_t&) noexcept
+{
+  return allocate(size, __STDCPP_DEFAULT_NEW_ALIGNMENT__);
+}
+void* operator new(std::size_t size, std::align_val_t align, const std::nothrow_t&) noexcept
+{
+  return allocate(size, static_cast<std::size_t>(align));
+}
+void* operator new[](std::size_t size, std::align_val_t align, const std::nothrow_t&) noexcept
+{
+  return allocate(size, static_cast<std::size_t>(align));
+}
+
+void operator delete(void* ptr) noexcept
+{
+  release(ptr);
+}
+void operator delete[](void* ptr) noexcept
+{
+  release(ptr);
+}
+void operator delete(void* ptr, std::size_t) noexcept
+{
+  release(ptr);
+}
+void operator delete[](void* ptr, std::size_t) noexcept
+{
+  release(ptr);
+}
+void operator delete(void* ptr, std::align_val_t) noexcept
+{
+  release(ptr);
+}
+void operator delete[](void* ptr, std::align_val_t) noexcept
+{
+  release(ptr);
+}
+void operator delete(void* ptr, std::size_t, std::align_val_t) noexcept
+{
+  release(ptr);
+}
+void operator delete[](void* ptr, std::size_t, std::align_val_t) noexcept
+{
+  release(ptr);
+}
+void operator delete(void* ptr, const std::nothrow_t&) noexcept
+{
+  release(ptr);
+}
+void operator delete[](void* ptr, const std::nothrow_t&) noexcept
+{
+  release(ptr);
+}
+void operator delete(void* ptr, std::align_val_t, const std::nothrow_t&) noexcept
+{
+  release(ptr);
+}
+void operator delete[](void* ptr, std::align_val_t, const std::nothrow_t&) noexcept
+{
+  release(ptr);
+}
@@ -0,0 +1,447 @@
+#include "bump/async_reader.h"
+
+#include <algorithm>
+#include <atomic>
+#include <cerrno>
+#include <cstdint>
+#include <fcntl.h>
+#include <new>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#include <vector>
+
+#ifdef __linux__
+#include <linux/io_uring.h>
+#include <sys/syscall.h>
+#endif
+
+using namespace bump;
+
+#ifdef __linux__
+//submission and completion rings of one io_uring instance, mapped by hand without liburing
+struct async_reader::uring
+{
+  int fd = -1;
+  unsigned depth = 0;
+  void* sq_ring = MAP_FAILED;
+  void* cq_ring = MAP_FAILED;
+  size_t sq_ring_size = 0;
+  size_t cq_ring_size = 0;
+  io_uring_sqe* sqes = static_cast<io_uring_sqe*>(MAP_FAILED);
+  size_t sqes_size = 0;
+
+  unsigned* sq_head = nullptr;
+  unsigned* sq_tail = nullptr;
+  unsigned* sq_mask = nullptr;
+  unsigned* sq_array = nullptr;
+  unsigned* cq_head = nullptr;
+  unsigned* cq_tail = nullptr;
+  unsigned* cq_mask = nullptr;
+  io_uring_cqe* cqes = nullptr;
+
+  template<typename T>
+  static T* at(void* ring, size_t offset) noexcept
+  {
+    return reinterpret_cast<T*>(static_cast<std::byte*>(ring) + offset);
+  }
+
+  //IORING_OP_READ came with 5.6, like the probe itself: a kernel that cannot be probed has no
+  //READ either and would fail every read with -EINVAL
+  bool supports_read() noexcept
+  {
+    constexpr unsigned ops = IORING_OP_LAST;
+    constexpr size_t bytes = sizeof(io_uring_probe) + ops * sizeof(io_uring_probe_op);
+    alignas(io_uring_probe) std::byte storage[bytes]{};
+    auto* probe = reinterpret_cast<io_uring_probe*>(storage);
+    if (::syscall(__NR_io_uring_register, fd, IORING_REGISTER_PROBE, probe, ops) < 0)
+    {
+      return false;
+    }
+    return probe->last_op >= IORING_OP_READ &&
+           (probe->ops[IORING_OP_READ].flags & IO_URING_OP_SUPPORTED);
+  }
+
+  //false if the kernel has no io_uring, does not allow it (seccomp, io_uring_disabled) or has
+  //no IORING_OP_READ
+  bool setup(unsigned entries) noexcept
+  {
+    io_uring_params params{};
+    fd = static_cast<int>(::syscall(__NR_io_uring_setup, entries, &params));
+    if (fd < 0 || !supports_read())
+    {
+      return false;
+    }
+    depth = params.sq_entries;
+    sq_ring_size = params.sq_off.array + params.sq_entries * sizeof(unsigned);
+    cq_ring_size = params.cq_off.cqes + params.cq_entries * sizeof(io_uring_cqe);
+    bool single = params.features & IORING_FEAT_SINGLE_MMAP;
+    if (single)
+    {
+      sq_ring_size = cq_ring_size = std::max(sq_ring_size, cq_ring_size);
+    }
+    sq_ring = ::mmap(nullptr, sq_ring_size, PROT_READ | PROT_WRITE, MAP_SHARED | MAP_POPULATE, fd,
+                     IORING_OFF_SQ_RING);
+    if (sq_ring == MAP_FAILED)
+    {
+      return false;
+    }
+    cq_ring = single ? sq_ring
+                     : ::mmap(nullptr, cq_ring_size, PROT_READ | PROT_WRITE,
+                              MAP_SHARED | MAP_POPULATE, fd, IORING_OFF_CQ_RING);
+    if (cq_ring == MAP_FAILED)
+    {
+      return false;
+    }
+    sqes_size = params.sq_entries * sizeof(io_uring_sqe);
+    sqes = static_cast<io_uring_sqe*>(::mmap(nullptr, sqes_size, PROT_READ | PROT_WRITE,
+                                             MAP_SHARED | MAP_POPULATE, fd, IORING_OFF_SQES));
+    if (sqes == MAP_FAILED)
+    {
+      return false;
+    }
+    sq_head = at<unsigned>(sq_ring, params.sq_off.head);
+    sq_tail = at<unsigned>(sq_ring, params.sq_off.tail);
+    sq_mask = at<unsigned>(sq_ring, params.sq_off.ring_mask);
+    sq_array = at<unsigned>(sq_ring, params.sq_off.array);
+    cq_head = at<unsigned>(cq_ring, params.cq_off.head);
+    cq_tail = at<unsigned>(cq_ring, params.cq_off.tail);
+    cq_mask = at<unsigned>(cq_ring, params.cq_off.ring_mask);
+    cqes = at<io_uring_cqe>(cq_ring, params.cq_off.cqes);
+    return true;
+  }
+
+  ~uring()
+  {
+    if (sqes != MAP_FAILED)
+    {
+      ::munmap(sqes, sqes_size);
+    }
+    if (cq_ring != MAP_FAILED && cq_ring != sq_ring)
+    {
+      ::munmap(cq_ring, cq_ring_size);
+    }
+    if (sq_ring != MAP_FAILED)
+    {
+      ::munmap(sq_ring, sq_ring_size);
+    }
+    if (fd >= 0)
+    {
+      ::close(fd);
+    }
+  }
+
+  //the caller keeps at most `depth` reads in flight, so there is always a free entry
+  void prepare_read(int file, std::byte* buffer, size_t bytes, size_t offset, size_t tag) noexcept
+  {
+    unsigned tail = *sq_tail;
+    unsigned index = tail & *sq_mask;
+    io_uring_sqe& sqe = sqes[index];
+    sqe = {};
+    sqe.opcode = IORING_OP_READ;
+    sqe.fd = file;
+    sqe.addr = reinterpret_cast<std::uintptr_t>(buffer);
+    sqe.len = static_cast<unsigned>(std::min(bytes, size_t{1} << 30));
+    sqe.off = offset;
+    sqe.user_data = tag;
+    sq_array[index] = index;
+    std::atomic_ref(*sq_tail).store(tail + 1, std::memory_order_release);
+  }
+
+  //asks the kernel to cancel the read tagged `tag`, its completion carries cancel_tag
+  static constexpr size_t cancel_tag = SIZE_MAX;
+  void prepare_cancel(size_t tag) noexcept
+  {
+    unsigned tail = *sq_tail;
+    unsigned index = tail & *sq_mask;
+    io_uring_sqe& sqe = sqes[index];
+    sqe = {};
+    sqe.opcode = IORING_OP_ASYNC_CANCEL;
+    sqe.fd = -1;
+    sqe.addr = tag;
+    sqe.user_data = cancel_tag;
+    sq_array[index] = index;
+    std::atomic_ref(*sq_tail).store(tail + 1, std::memory_order_release);
+  }
+
+  //takes back the entries the kernel has not taken yet, without SQPOLL it only reads them in
+  //enter(). Calls func(tag) for each of them
+  template<typename Func>
+  void retract(Func&& func) noexcept
+  {
+    unsigned head = std::atomic_ref(*sq_head).load(std::memory_order_acquire);
+    for (unsigned it = head; it != *sq_tail; ++it)
+    {
+      func(static_cast<size_t>(sqes[sq_array[it & *sq_mask]].user_data));
+    }
+    std::atomic_ref(*sq_tail).store(head, std::memory_order_release);
+  }
+
+  //submits what the kernel has not taken yet and waits for `wait` completions
+  int enter(unsigned wait) noexcept
+  {
+    unsigned pending = *sq_tail - std::atomic_ref(*sq_head).load(std::memory_order_acquire);
+    return static_cast<int>(::syscall(__NR_io_uring_enter, fd, pending, wait,
+                                      IORING_ENTER_GETEVENTS, nullptr, 0));
+  }
+
+  template<typename Func>
+  void reap(Func&& func) noexcept
+  {
+    unsigned head = *cq_head;
+    unsigned tail = std::atomic_ref(*cq_tail).load(std::memory_order_acquire);
+    for (; head != tail; ++head)
+    {
+      const io_uring_cqe& cqe = cqes[head & *cq_mask];
+      func(static_cast<size_t>(cqe.user_data), cqe.res);
+    }
+    std::atomic_ref(*cq_head).store(head, std::memory_order_release);
+  }
+};
+#else
+struct async_reader::uring
+{
+  bool setup(unsigned) noexcept { return false; }
+};
+#endif
+
+namespace
+{
+struct progress
+{
+  int fd = -1;
+  size_t size = 0;
+  size_t done = 0;
+  bool finished = false;
+};
+
+int open_sized(const char* path, size_t& size) noexcept
+{
+  int fd = ::open(path, O_RDONLY | O_CLOEXEC);
+  if (fd < 0)
+  {
+    return -errno;
+  }
+  struct stat info{};
+  if (::fstat(fd, &info) != 0)
+  {
+    int error = errno;
+    ::close(fd);
+    return -error;
+  }
+  size = static_cast<size_t>(info.st_size);
+  return fd;
+}
+
+//pread until the buffer is full or the file ends, 0 or errno
+int read_rest(int fd, std::byte* buffer, size_t size, size_t& done) noexcept
+{
+  while (done < size)
+  {
+    ssize_t bytes = ::pread(fd, buffer + done, size - done, static_cast<off_t>(done));
+    if (bytes < 0)
+    {
+      if (errno == EINTR)
+      {
+        continue;
+      }
+      return errno;
+    }
+    if (bytes == 0)
+    {
+      break; //the file shrank since fstat
+    }
+    done += bytes;
+  }
+  return 0;
+}
+} // namespace
+
+async_reader::async_reader(unsigned queue_depth, bool use_io_uring)
+{
+  if (use_io_uring)
+  {
+    ring = std::make_unique<uring>();
+    if (!ring->setup(std::max(queue_depth, 1U)))
+    {
+      ring.reset();
+    }
+  }
+  if (!ring)
+  {
+    pool.emplace();
+  }
+}
+
+async_reader::~async_reader() = default;
+
+std::span<async_reader::file> async_reader::read(BumpAllocator& arena,
+                                                 std::span<const char* const> paths)
+{
+  size_t count = paths.size();
+  auto* files = static_cast<file*>(arena.allocate(count * sizeof(file), alignof(file)));
+  if (files == nullptr)
+  {
+    throw std::bad_alloc();
+  }
+  std::vector<progress> state(count);
+
+  auto open = [&](size_t i)
+  {
+    int fd = open_sized(paths[i], state[i].size);
+    state[i].fd = fd;
+    state[i].finished = fd < 0 || state[i].size == 0;
+    files[i] = {paths[i], {}, fd < 0 ? -fd : 0};
+  };
+  if (pool)
+  {
+    pool->parallel_for(count, open);
+  }
+  else
+  {
+    for (size_t i = 0; i < count; ++i)
+    {
+      open(i);
+    }
+  }
+  //buffers are carved on this thread, only the reads into them run on workers or in the kernel
+  for (size_t i = 0; i < count; ++i)
+  {
+    if (!state[i].finished)
+    {
+      void* buffer = arena.allocate(state[i].size, alignof(std::max_align_t));
+      if (buffer == nullptr)
+      {
+        for (progress& read: state)
+        {
+          if (read.fd >= 0)
+          {
+            ::close(read.fd);
+          }
+        }
+        throw std::bad_alloc();
+      }
+      files[i].data = {static_cast<std::byte*>(buffer), state[i].size};
+    }
+  }
+
+#ifdef __linux__
+  if (ring)
+  {
+    std::vector<size_t> todo;
+    for (size_t i = count; i-- > 0;)
+    {
+      if (!state[i].finished)
+      {
+        todo.push_back(i);
+      }
+    }
+    std::vector<bool> in_ring(count);
+    unsigned inflight = 0;
+    auto failed = []
+    {
+      return errno != EINTR && errno != EAGAIN && errno != EBUSY;
+    };
+    auto complete = [&](size_t i, int result, bool requeue)
+    {
+      if (i == uring::cancel_tag)
+      {
+        return;
+      }
+      --inflight;
+      in_ring[i] = false;
+      progress& read = state[i];
+      if (result == -ECANCELED && !requeue)
+      {
+        return; //the thread_pool reads the rest
+      }
+      if (result < 0)
+      {
+        files[i].error = -result;
+        read.finished = true;
+        return;
+      }
+      read.done += result;
+      read.finished = result == 0 || read.done == read.size; //0: the file shrank since fstat
+      if (!read.finished && requeue)
+      {
+        todo.push_back(i); //short read, queue the rest
+      }
+    };
+    while (!todo.empty() || inflight)
+    {
+      for (; !todo.empty() && inflight < ring->depth; ++inflight)
+      {
+        size_t i = todo.back();
+        todo.pop_back();
+        in_ring[i] = true;
+        ring->prepare_read(state[i].fd, files[i].data.data() + state[i].done,
+                           state[i].size - state[i].done, state[i].done, i);
+      }
+      if (ring->enter(1) >= 0 || !failed())
+      {
+        ring->reap([&](size_t i, int result) { complete(i, result, true); });
+        continue;
+      }
+      //the ring is unusable, whatever is left is read by the thread_pool below. Reads the kernel
+      //took are cancelled and waited for first, none may land in a buffer a worker fills
+      int error = errno;
+      ring->retract([&](size_t i)
+      {
+        --inflight;
+        in_ring[i] = false;
+      });
+      for (size_t i = 0; i < count; ++i)
+      {
+        if (in_ring[i])
+        {
+          ring->prepare_cancel(i);
+        }
+      }
+      while (inflight)
+      {
+        if (ring->enter(1) < 0 && failed())
+        {
+          //nothing can be waited for anymore: the files still in the kernel fail, closing the
+          //ring cancels their reads
+          for (size_t i = 0; i < count; ++i)
+          {
+            if (in_ring[i])
+            {
+              files[i].error = error;
+              state[i].finished = true;
+            }
+          }
+          break;
+        }
+        ring->reap([&](size_t i, int result) { complete(i, result, false); });
+      }
+      ring.reset();
+      pool.emplace();
+      break;
+    }
+  }
+#endif
+
+  if (pool)
+  {
+    pool->parallel_for(count, [&](size_t i)
+    {
+      if (!state[i].finished)
+      {
+        files[i].error = read_rest(state[i].fd, files[i].data.data(), state[i].size, state[i].done);
+        state[i].finished = true;
+      }
+    });
+  }
+
+  for (size_t i = 0; i < count; ++i)
+  {
+    if (state[i].fd >= 0)
+    {
+      ::close(state[i].fd);
+    }
+    files[i].data = files[i].error ? std::span<std::byte>{} : files[i].data.first(state[i].done);
+  }
+  return {files, count};
+}
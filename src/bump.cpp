@@ -2,14 +2,27 @@
 // Created by Klemens Aimetti on 16.01.26.
 //
 #include "bump/bump.h"
+#include "bump/refiller.h"
 
+#include <chrono>
+#include <cstring>
+#include <map>
+#include <mutex>
+#include <string>
+#include <utility>
+#include <sys/mman.h>
+#include <unistd.h>
+
+#ifdef __SSE2__
+#include <emmintrin.h>
+#endif
 
 using namespace bump;
 
 
 BumpAllocator::Frame BumpAllocator::getFrame() noexcept
 {
-  return Frame{current, current->index};
+  return Frame{current, current->index, regions};
 
 }
 
@@ -17,14 +30,81 @@ BumpAllocator::Frame BumpAllocator::getFrame() noexcept
 void BumpAllocator::restoreFrame(const Frame &frame) noexcept
 {
   assert(frame.current);
+  if (sealed())
+  {
+    return;
+  }
+  peak = high_water();
+  IF_TRACKING(info.peak_used = std::max(info.peak_used, peak));
+  if (frame.current == root && frame.iterator == root->payload)
+  {
+    profile->record(peak);
+    peak = 0;
+  }
+  while (regions != frame.regions)
+  {
+    unmap_region();
+  }
+  IF_TRACKING(size_t released = used());
   current = frame.current;
-  current->index = frame.iterator;
-  IF_TRACKING(info.total_free += current->index - frame.iterator);
-
+  current->rewind(frame.iterator);
+  IF_TRACKING(info.total_free += released - used());
+  //later blocks keep their stale index, allocate_if_failed resets them when it moves on
+  ++epoch;
+  if (trimming && epoch % trimming->interval == 0)
+  {
+    trim();
+  }
+}
 
-  for (auto it = current->next; it; it = it->next){
-    IF_TRACKING(info.total_free += current->used(););
-    current->index = current->payload;
+void BumpAllocator::trim() noexcept
+{
+  if (!trimming)
+  {
+    return;
+  }
+  static const size_t page = ::sysconf(_SC_PAGESIZE);
+  size_t retained = 0;
+  Node* previous = current;
+  for (Node* it = current->next; it;)
+  {
+    Node* next = it->next;
+    if (it->last_used == Node::pages_released)
+    {
+      previous = it;
+      it = next;
+      continue;
+    }
+    bool idle = trimming->max_idle_frames && epoch - it->last_used > trimming->max_idle_frames;
+    if (!idle && retained + it->full_size() <= trimming->retained_budget)
+    {
+      retained += it->full_size();
+      previous = it;
+    }
+    else if (trimming->release_pages)
+    {
+      auto first = (reinterpret_cast<std::uintptr_t>(it->payload) + page - 1) & ~(page - 1);
+      auto last = reinterpret_cast<std::uintptr_t>(it->end) & ~(page - 1);
+      if (first < last)
+      {
+        ::madvise(reinterpret_cast<void*>(first), last - first, MADV_DONTNEED);
+      }
+      if (!upstream && last == reinterpret_cast<std::uintptr_t>(it->end) && first < last)
+      {
+        //private anonymous pages come back zero-filled, so a page aligned block (NUMA) is zero
+        //from its first whole page on
+        it->index = it->payload;
+        it->zeroed = reinterpret_cast<std::byte*>(first);
+      }
+      it->last_used = Node::pages_released;
+      previous = it;
+    }
+    else
+    {
+      previous->next = next;
+      release_block(it);
+    }
+    it = next;
   }
 }
 
@@ -60,6 +140,7 @@ void* BumpAllocator::try_allocate(size_t bytes, size_t align) noexcept
   std::byte* aligned_ptr = get_aligned(current, align);
   if (aligned_ptr + bytes <= current->end) {
     IF_TRACKING(info.total_free -= (aligned_ptr + bytes) - current->index);
+    IF_TRACKING(++info.fast_hits);
     current->index = aligned_ptr + bytes;
     return aligned_ptr;
   }
@@ -70,38 +151,203 @@ void* BumpAllocator::allocate_if_failed(size_t bytes, size_t align) noexcept
   std::byte* aligned_ptr = get_aligned(current, align);
   if (aligned_ptr + bytes <= current->end) {
     IF_TRACKING(info.total_free -= (aligned_ptr + bytes) - current->index);
+    IF_TRACKING(++info.fast_hits);
     current->index = aligned_ptr + bytes;
     return aligned_ptr;
   }
+  if (sealed())
+  {
+    return nullptr;
+  }
 
+  IF_TRACKING(++info.slow_paths);
+  IF_TRACKING(auto slow_start = std::chrono::steady_clock::now());
   while (true) {
+    size_t before = used();
+    IF_TRACKING(info.tail_waste += current->remaining());
     if (current->next) {
       current = current->next;
-      current->index = current->payload;
+      current->rewind(current->payload);
     } else {
       size_t exponential = std::min(current->capacity() * 2, 256UL * 1024UL);
       size_t minimum = std::max(size_t{1024}, bytes + align - 1);
-      size_t capacity = std::max(minimum, exponential);
-      auto allocation = std::allocator<std::byte>{}.allocate_at_least(sizeof(Node) + capacity);
-      current->next = new (allocation.ptr) Node(allocation.count - sizeof(Node), nullptr);
-      current = current->next;
-
-      IF_TRACKING(info.total_free += (allocation.count));
-      IF_TRACKING(info.total_malloc += (allocation.count));
+      //reserve whatever earlier runs needed beyond this point in one block
+      size_t learned = profile->hint();
+      size_t expected = learned > before ? learned - before : 0;
+      size_t capacity = std::max({minimum, exponential, expected});
+      Node* block = new_block(capacity);
+      if (block == nullptr)
+      {
+        return nullptr; //the upstream is out of memory
+      }
+      current->next = block;
+      current = block;
     }
+    current->before = before;
 
     aligned_ptr = get_aligned(current, align);
     if (aligned_ptr + bytes <= current->end) {
       IF_TRACKING(info.total_free -= (aligned_ptr + bytes) - current->index);
+      current->last_used = epoch;
 
       current->index = aligned_ptr + bytes;
+      IF_TRACKING(info.RecordSlowPath(std::chrono::duration_cast<std::chrono::nanoseconds>(
+        std::chrono::steady_clock::now() - slow_start).count()));
       return aligned_ptr;
     }
   }
 }
 
+Node* BumpAllocator::allocate_block(size_t capacity, int numa_node) noexcept
+{
+  if (numa_node != numa::none)
+  {
+    if (auto block = numa::allocate(sizeof(Node) + capacity, numa_node); block.ptr)
+    {
+      Node* node = new (block.ptr) Node(block.size - sizeof(Node), nullptr);
+      node->numa_node = block.node;
+      node->zeroed = block.zeroed ? node->payload : node->end;
+      return node;
+    }
+  }
+  auto allocation = std::allocator<std::byte>{}.allocate_at_least(sizeof(Node) + capacity);
+  return new (allocation.ptr) Node(allocation.count - sizeof(Node), nullptr);
+}
+
+void BumpAllocator::deallocate_block(Node* node) noexcept
+{
+  if (node->numa_node != numa::none)
+  {
+    numa::release({node, node->full_size(), node->numa_node});
+    return;
+  }
+  std::allocator<std::byte>{}.deallocate(reinterpret_cast<std::byte*>(node), node->full_size());
+}
+
+void BumpAllocator::prefault(Node* node) noexcept
+{
+  static const size_t page = ::sysconf(_SC_PAGESIZE);
+#ifdef MADV_POPULATE_WRITE
+  auto first = (reinterpret_cast<std::uintptr_t>(node->payload) + page - 1) & ~(page - 1);
+  auto last = reinterpret_cast<std::uintptr_t>(node->end) & ~(page - 1);
+  if (first >= last || ::madvise(reinterpret_cast<void*>(first), last - first, MADV_POPULATE_WRITE) == 0)
+  {
+    return;
+  }
+#endif
+  for (std::byte* it = node->payload; it < node->end; it += page)
+  {
+    *reinterpret_cast<volatile std::byte*>(it) = std::byte{0};
+  }
+}
+
+Node* BumpAllocator::upstream_block(size_t capacity) noexcept
+{
+  //an upstream may run out either way: by throwing or, like the guard of a sealed arena, by
+  //returning nullptr
+  void* memory = nullptr;
+  try
+  {
+    memory = upstream->allocate(sizeof(Node) + capacity, alignof(Node));
+  }
+  catch (const std::bad_alloc&)
+  {
+  }
+  return memory ? new (memory) Node(capacity, nullptr) : nullptr;
+}
+
+Node* BumpAllocator::new_block(size_t capacity) noexcept
+{
+  Node* node = refill ? refill->take(capacity) : nullptr;
+  if (node == nullptr)
+  {
+    node = upstream ? upstream_block(capacity) : allocate_block(capacity, numa_node);
+    if (node == nullptr)
+    {
+      return nullptr;
+    }
+    if (prefault_blocks)
+    {
+      prefault(node);
+    }
+  }
+  IF_TRACKING(info.total_free += node->full_size());
+  IF_TRACKING(info.total_malloc += node->full_size());
+  IF_TRACKING(++info.blocks_added);
+  IF_TRACKING(++info.blocks);
+  return node;
+}
+
+void BumpAllocator::release_block(Node* node) noexcept
+{
+  IF_TRACKING(info.total_malloc -= node->full_size());
+  IF_TRACKING(info.total_free -= node->full_size());
+  IF_TRACKING(--info.blocks);
+  if (upstream)
+  {
+    upstream->deallocate(node, node->full_size(), alignof(Node));
+    return;
+  }
+  deallocate_block(node);
+}
+
+void BumpAllocator::SetRefill(bool enabled) noexcept
+{
+  if (enabled && !refill && !upstream)
+  {
+    size_t first = std::max(std::min(root->capacity() * 2, 256UL * 1024UL), profile->hint());
+    refill = new refill_slot(first, numa_node == numa::local ? numa::current_node() : numa_node);
+    refiller::instance().add(refill);
+  }
+  else if (!enabled && refill)
+  {
+    refiller::instance().remove(refill);
+    delete refill;
+    refill = nullptr;
+  }
+}
+
+bool BumpAllocator::try_extend(void* allocation, size_t bytes, size_t new_bytes) noexcept
+{
+  auto* begin = static_cast<std::byte*>(allocation);
+  if (begin + bytes != current->index || new_bytes > static_cast<size_t>(current->end - begin) ||
+      sealed())
+  {
+    return false;
+  }
+  IF_TRACKING(info.total_free -= new_bytes - bytes);
+  current->rewind(begin + new_bytes);
+  return true;
+}
+
+void BumpAllocator::reserve(size_t bytes) noexcept
+{
+  if (remainingBytes() < bytes)
+  {
+    auto* block = static_cast<std::byte*>(allocate_if_failed(bytes, 1));
+    if (block)
+    {
+      IF_TRACKING(info.total_free += bytes);
+      current->index = block; //nothing was written, the zero watermark stays where it is
+    }
+  }
+}
+
 void *BumpAllocator::allocate(size_t bytes, size_t align) noexcept
 {
+  return allocate(bytes, align, __builtin_return_address(0));
+}
+
+void* BumpAllocator::allocate(size_t bytes, size_t align, const void* site) noexcept
+{
+#ifdef BUMP_TRACK_HEAP
+  if (info.sites.enabled()) [[unlikely]]
+  {
+    info.sites.Sample(site, bytes);
+  }
+#else
+  (void)site;
+#endif
   if (void* alloc = try_allocate(bytes, align))
   {
     return alloc;
@@ -109,39 +355,126 @@ void *BumpAllocator::allocate(size_t bytes, size_t align) noexcept
   return allocate_if_failed(bytes, align);
 }
 
+void* BumpAllocator::allocate_sampled(size_t bytes, size_t align) noexcept
+{
+  return allocate(bytes, align, __builtin_return_address(0));
+}
+
+namespace
+{
+//above this the cleared memory would push the rest of the cache out, so it bypasses the cache
+constexpr size_t non_temporal_bytes = 1024 * 1024;
+
+void clear(std::byte* begin, size_t bytes) noexcept
+{
+#ifdef __SSE2__
+  if (bytes >= non_temporal_bytes)
+  {
+    auto* aligned = reinterpret_cast<std::byte*>(
+      (reinterpret_cast<std::uintptr_t>(begin) + 63) & ~std::uintptr_t{63});
+    std::byte* last = begin + bytes;
+    std::memset(begin, 0, aligned - begin);
+    const __m128i zero = _mm_setzero_si128();
+    for (; aligned + 64 <= last; aligned += 64)
+    {
+      auto* line = reinterpret_cast<__m128i*>(aligned);
+      _mm_stream_si128(line, zero);
+      _mm_stream_si128(line + 1, zero);
+      _mm_stream_si128(line + 2, zero);
+      _mm_stream_si128(line + 3, zero);
+    }
+    _mm_sfence();
+    std::memset(aligned, 0, last - aligned);
+    return;
+  }
+#endif
+  std::memset(begin, 0, bytes);
+}
+} // namespace
+
+void* BumpAllocator::allocate_zeroed(size_t bytes, size_t align) noexcept
+{
+  auto* allocation = static_cast<std::byte*>(allocate(bytes, align));
+  if (allocation == nullptr)
+  {
+    return nullptr; //sealed arena
+  }
+  //the allocation is in the current block, everything in it from the watermark on is zero
+  std::byte* dirty_end = std::min(allocation + bytes, current->zeroed);
+  if (dirty_end > allocation)
+  {
+    clear(allocation, dirty_end - allocation);
+  }
+  return allocation;
+}
+
 void BumpAllocator::free() noexcept
 {
+  if (sealed())
+  {
+    current->end = std::exchange(sealed_end, nullptr);
+  }
+  IF_TRACKING(info.peak_used = std::max(info.peak_used, high_water()));
+  if (high_water() != 0)
+  {
+    profile->record(high_water());
+    peak = 0;
+  }
+  while (regions)
+  {
+    unmap_region();
+  }
   for (auto it = root->next; it != nullptr;)
   {
     Node *next = it->next;
-    size_t node_size = it->full_size();
-    std::allocator<std::byte>{}.deallocate(reinterpret_cast<std::byte*>(it), node_size);
-    IF_TRACKING(info.total_malloc -= node_size);
-    IF_TRACKING(info.total_free -= it->remaining(););
+    release_block(it);
     it = next;
   }
-  IF_TRACKING(
-    info.total_malloc -= root->full_size();
-    info.total_free -= root->remaining();
-    );
-
 
-  root->index = root->payload;
+  root->rewind(root->payload);
   root->next = nullptr;
   current = root;
+  IF_TRACKING(info.total_free = info.total_malloc);
+}
+
+void usage_profile::record(size_t used) noexcept
+{
+  size_t old = peak.load(std::memory_order_relaxed);
+  size_t decayed;
+  do
+  {
+    decayed = used >= old ? used : old - (old - used) / 8;
+  } while (!peak.compare_exchange_weak(old, decayed, std::memory_order_relaxed));
+}
+
+usage_profile& usage_profile::named(const char* site)
+{
+  static std::mutex mutex;
+  static std::map<std::string, usage_profile, std::less<>> profiles;
+  std::lock_guard lock(mutex);
+  auto it = profiles.find(std::string_view(site));
+  if (it == profiles.end())
+  {
+    it = profiles.try_emplace(site).first;
+  }
+  return it->second;
 }
 
 BumpAllocator::~BumpAllocator() noexcept
 {
   free();
+  SetRefill(false);
 }
 
-BumpAllocator::BumpAllocator(std::byte* stack_buffer, size_t capacity) noexcept
+BumpAllocator::BumpAllocator(std::byte* stack_buffer, size_t capacity,
+                             std::pmr::memory_resource* upstream) noexcept
+  : upstream(upstream)
 {
   root = new (stack_buffer) Node(capacity - sizeof(Node), nullptr);
   current = root;
   IF_TRACKING(info.total_free = root->remaining());
   IF_TRACKING(info.total_malloc = root->remaining());
+  IF_TRACKING(info.blocks = 1);
 }
 
 using iterator = typename BumpAllocator::Frame::Iterator;
@@ -0,0 +1,115 @@
+#include "bump/bump.h"
+
+#include <cerrno>
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+using namespace bump;
+
+std::optional<BumpAllocator::Frame::Iterator> BumpAllocator::map_file(const char* path) noexcept
+{
+  if (sealed())
+  {
+    return {};
+  }
+  int fd = ::open(path, O_RDONLY | O_CLOEXEC);
+  if (fd < 0)
+  {
+    return {};
+  }
+  struct stat info{};
+  if (::fstat(fd, &info) != 0)
+  {
+    ::close(fd);
+    return {};
+  }
+  size_t length = info.st_size;
+  if (length == 0)
+  {
+    ::close(fd);
+    return Frame::Iterator(*this, getFrame());
+  }
+
+  //one writable page in front of the file holds the Node header, so payload == first byte of the file
+  size_t page = ::sysconf(_SC_PAGESIZE);
+  size_t total = page + length;
+  auto* base = static_cast<std::byte*>(
+    ::mmap(nullptr, total, PROT_READ | PROT_WRITE, MAP_PRIVATE | MAP_ANONYMOUS, -1, 0));
+  if (base == MAP_FAILED)
+  {
+    ::close(fd);
+    return {};
+  }
+  if (::mmap(base + page, length, PROT_READ, MAP_PRIVATE | MAP_FIXED, fd, 0) == MAP_FAILED)
+  {
+    ::munmap(base, total);
+    ::close(fd);
+    return {};
+  }
+  ::close(fd);
+
+  auto* region = push<MappedRegion>();
+  Node* node = new (base + page - sizeof(Node)) Node(length, current->next);
+  node->index = node->end;
+  //the file is no arena memory: used() stays where it was, so peaks, usage profiles and
+  //tracking only see what was allocated
+  node->mapped = true;
+  node->before = used();
+  *region = MappedRegion{regions, current, node, base, total};
+  regions = region;
+
+  current->next = node;
+  current = node;
+  return Frame::Iterator(*this, Frame{node, node->payload, regions});
+}
+
+void BumpAllocator::unmap_region() noexcept
+{
+  MappedRegion region = *regions;
+  region.before->next = region.node->next;
+  if (current == region.node)
+  {
+    current = region.before;
+  }
+  regions = region.previous;
+  ::munmap(region.base, region.length);
+}
+
+std::optional<BumpAllocator::Frame::Iterator> BumpAllocator::read_file(const char* path,
+                                                                        size_t chunk) noexcept
+{
+  if (sealed())
+  {
+    return {};
+  }
+  int fd = ::open(path, O_RDONLY | O_CLOEXEC);
+  if (fd < 0)
+  {
+    return {};
+  }
+  Frame start = getFrame();
+  while (true)
+  {
+    reserve(chunk);
+    ssize_t bytes = ::read(fd, end(), remainingBytes());
+    if (bytes < 0)
+    {
+      if (errno == EINTR)
+      {
+        continue;
+      }
+      ::close(fd);
+      restoreFrame(start);
+      return {};
+    }
+    if (bytes == 0)
+    {
+      break;
+    }
+    allocateUnaligned(bytes);
+  }
+  ::close(fd);
+  return Frame::Iterator(*this, start);
+}
@@ -0,0 +1,35 @@
+#include "bump/frozen.h"
+
+#include <cstdint>
+#include <sys/mman.h>
+#include <unistd.h>
+
+using namespace bump;
+
+void detail::protect_blocks(BumpAllocator& arena, bool read_only) noexcept
+{
+  static const size_t page = ::sysconf(_SC_PAGESIZE);
+  int protection = read_only ? PROT_READ : PROT_READ | PROT_WRITE;
+  //regions are mapped read-only already
+  MappedRegion* region = arena.regions;
+  for (Node* node = arena.root;; node = node->next)
+  {
+    bool mapped = false;
+    for (MappedRegion* it = region; it && !mapped; it = it->previous)
+    {
+      mapped = it->node == node;
+    }
+    //the block's real end, the current block's end is pulled down while sealed
+    std::byte* end = node == arena.current && arena.sealed() ? arena.sealed_end : node->end;
+    auto first = (reinterpret_cast<std::uintptr_t>(node->payload) + page - 1) & ~(page - 1);
+    auto last = reinterpret_cast<std::uintptr_t>(end) & ~(page - 1);
+    if (!mapped && first < last)
+    {
+      ::mprotect(reinterpret_cast<void*>(first), last - first, protection);
+    }
+    if (node == arena.current)
+    {
+      break;
+    }
+  }
+}
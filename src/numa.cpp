@@ -0,0 +1,153 @@
+#include "bump/numa.h"
+
+#include <algorithm>
+#include <fstream>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <vector>
+#include <sys/mman.h>
+#include <unistd.h>
+
+#ifdef __linux__
+#include <sys/syscall.h>
+#endif
+
+using namespace bump;
+
+namespace
+{
+constexpr size_t pooled_blocks_per_node = 64;
+constexpr int preferred_policy = 1; //MPOL_PREFERRED, falls back to other nodes when full
+
+struct node_pool
+{
+  std::mutex mutex;
+  std::vector<numa::block> blocks;
+};
+
+size_t page_size()
+{
+  static const size_t page = ::sysconf(_SC_PAGESIZE);
+  return page;
+}
+
+unsigned detect_nodes()
+{
+#ifdef __linux__
+  //"0" or "0-1"
+  std::ifstream possible("/sys/devices/system/node/possible");
+  std::string range;
+  if (possible >> range)
+  {
+    auto dash = range.find('-');
+    if (dash != std::string::npos)
+    {
+      return std::stoul(range.substr(dash + 1)) + 1;
+    }
+  }
+#endif
+  return 1;
+}
+
+node_pool& pool(int node)
+{
+  static std::unique_ptr<node_pool[]> pools(new node_pool[numa::node_count()]);
+  return pools[node];
+}
+
+void bind(void* ptr, size_t bytes, int node)
+{
+#ifdef __linux__
+  unsigned long mask[4] = {};
+  if (node < static_cast<int>(sizeof(mask) * 8))
+  {
+    mask[node / 64] = 1UL << (node % 64);
+    ::syscall(SYS_mbind, ptr, bytes, preferred_policy, mask, sizeof(mask) * 8, 0);
+  }
+#endif
+}
+} // namespace
+
+unsigned numa::node_count() noexcept
+{
+  static const unsigned count = detect_nodes();
+  return count;
+}
+
+int numa::current_node() noexcept
+{
+#ifdef __linux__
+  unsigned cpu = 0;
+  unsigned node = 0;
+  if (node_count() > 1 && ::syscall(SYS_getcpu, &cpu, &node, nullptr) == 0)
+  {
+    return static_cast<int>(node);
+  }
+#endif
+  return 0;
+}
+
+numa::block numa::allocate(size_t bytes, int node) noexcept
+{
+  if (node == local || node < 0 || node >= static_cast<int>(node_count()))
+  {
+    node = current_node();
+  }
+  bytes = (bytes + page_size() - 1) & ~(page_size() - 1);
+
+  {
+    auto& recycled = pool(node);
+    std::lock_guard lock(recycled.mutex);
+    auto fit = std::find_if(recycled.blocks.begin(), recycled.blocks.end(), [&](const block& b)
+    {
+      return b.size >= bytes && b.size <= bytes * 2;
+    });
+    if (fit != recycled.blocks.end())
+    {
+      block reused = *fit;
+      *fit = recycled.blocks.back();
+      recycled.blocks.pop_back();
+      return reused;
+    }
+  }
+
+  void* ptr = ::mmap(nullptr, bytes, PROT_READ | PROT_WRITE, MAP_PRIVATE | MAP_ANONYMOUS, -1, 0);
+  if (ptr == MAP_FAILED)
+  {
+    return {nullptr, 0, node};
+  }
+  if (node_count() > 1)
+  {
+    bind(ptr, bytes, node); //before the first touch, so no page lands anywhere else
+  }
+  return {ptr, bytes, node, true};
+}
+
+void numa::release(const block& block) noexcept
+{
+  {
+    auto& recycled = pool(block.node);
+    std::lock_guard lock(recycled.mutex);
+    if (recycled.blocks.size() < pooled_blocks_per_node)
+    {
+      recycled.blocks.push_back(block);
+      return;
+    }
+  }
+  ::munmap(block.ptr, block.size);
+}
+
+void numa::drain() noexcept
+{
+  for (unsigned node = 0; node < node_count(); ++node)
+  {
+    auto& recycled = pool(static_cast<int>(node));
+    std::lock_guard lock(recycled.mutex);
+    for (const block& pooled: recycled.blocks)
+    {
+      ::munmap(pooled.ptr, pooled.size);
+    }
+    recycled.blocks.clear();
+  }
+}
@@ -0,0 +1,142 @@
+#include "bump/redirect.h"
+
+#include <algorithm>
+#include <cstdint>
+#include <utility>
+
+using namespace bump;
+
+namespace
+{
+thread_local redirect_scope* innermost = nullptr;
+thread_local bool growing = false; //arena blocks come from operator new themselves
+
+//sits right in front of every redirected allocation
+struct prefix
+{
+  size_t size;
+  size_t offset; //from the start of the arena allocation
+};
+static_assert(sizeof(prefix) <= __STDCPP_DEFAULT_NEW_ALIGNMENT__);
+
+prefix& prefix_of(const void* ptr) noexcept
+{
+  auto* byte = static_cast<std::byte*>(const_cast<void*>(ptr));
+  return *reinterpret_cast<prefix*>(byte - sizeof(prefix));
+}
+} // namespace
+
+redirect_scope::redirect_scope(BumpAllocator& arena) noexcept
+  : guard(arena), previous(std::exchange(innermost, this)), last_block(arena.current)
+{
+  add_block(guard.frame.iterator, last_block);
+}
+
+redirect_scope::~redirect_scope() noexcept
+{
+  innermost = previous;
+  growing = true; //the index goes back to the system heap
+  blocks = {};
+  growing = false;
+}
+
+void redirect_scope::add_block(const std::byte* begin, Node* block)
+{
+  range added{begin, block->end};
+  auto it = std::ranges::upper_bound(blocks, added.begin, {}, &range::begin);
+  //a block already known keeps its range, the part in front of the frame is not the scope's
+  bool known = (it != blocks.begin() && std::prev(it)->end > added.begin) ||
+               (it != blocks.end() && it->begin < added.end);
+  if (!known)
+  {
+    bool previous_growing = std::exchange(growing, true);
+    blocks.insert(it, added);
+    growing = previous_growing;
+  }
+}
+
+bool redirect_scope::contains(const std::byte* ptr) const noexcept
+{
+  auto it = std::ranges::upper_bound(blocks, ptr, {}, &range::begin);
+  return it != blocks.begin() && ptr < std::prev(it)->end;
+}
+
+void* redirect::allocate(size_t bytes, size_t align) noexcept
+{
+  if (innermost == nullptr || growing)
+  {
+    return nullptr;
+  }
+  size_t offset = std::max(align, size_t{__STDCPP_DEFAULT_NEW_ALIGNMENT__});
+  BumpAllocator& arena = innermost->guard.allocator;
+  growing = true;
+  //at least one byte, so the pointer lies inside the frame even for malloc(0)
+  auto* base = static_cast<std::byte*>(arena.allocate(offset + std::max(bytes, size_t{1}), offset));
+  growing = false;
+  if (base == nullptr)
+  {
+    return nullptr; //sealed arena, the system allocator takes over
+  }
+  if (arena.current != innermost->last_block)
+  {
+    innermost->last_block = arena.current;
+    innermost->add_block(arena.current->payload, arena.current);
+  }
+  std::byte* ptr = base + offset;
+  prefix_of(ptr) = {bytes, offset};
+  return ptr;
+}
+
+redirect_scope* redirect::owner(const void* ptr) noexcept
+{
+  auto* byte = static_cast<const std::byte*>(ptr);
+  for (redirect_scope* scope = innermost; scope; scope = scope->previous)
+  {
+    if (scope->contains(byte))
+    {
+      return scope;
+    }
+  }
+  return nullptr;
+}
+
+bool redirect::release(void* ptr) noexcept
+{
+  if (growing)
+  {
+    return false; //only the arena and the scope index free while growing, never frame memory
+  }
+  redirect_scope* scope = owner(ptr);
+  if (scope == nullptr)
+  {
+    return false;
+  }
+  if (scope == innermost)
+  {
+    //hands the memory back if nothing was allocated after it
+    const prefix& header = prefix_of(ptr);
+    auto* base = static_cast<std::byte*>(ptr) - header.offset;
+    scope->guard.allocator.try_extend(base, header.offset + std::max(header.size, size_t{1}), 0);
+  }
+  return true;
+}
+
+size_t redirect::size_of(const void* ptr) noexcept
+{
+  return owner(ptr) ? prefix_of(ptr).size : SIZE_MAX;
+}
+
+void* bump_redirect_allocate(size_t bytes, size_t align) noexcept
+{
+  return redirect::allocate(bytes, align);
+}
+
+bool bump_redirect_release(void* ptr) noexcept
+{
+  return redirect::release(ptr);
+}
+
+size_t bump_redirect_size(const void* ptr) noexcept
+{
+  return redirect::size_of(ptr);
+}
@@ -0,0 +1,105 @@
+#include "bump/refiller.h"
+
+#include <algorithm>
+
+using namespace bump;
+
+refill_slot::~refill_slot()
+{
+  if (Node* node = spare.exchange(nullptr, std::memory_order_acquire))
+  {
+    BumpAllocator::deallocate_block(node);
+  }
+}
+
+Node* refill_slot::take(size_t needed) noexcept
+{
+  Node* node = spare.exchange(nullptr, std::memory_order_acquire);
+  if (node == nullptr)
+  {
+    //refiller fell behind, make sure the next spare is big enough for this kind of request
+    capacity.store(std::max(needed, capacity.load(std::memory_order_relaxed)),
+                   std::memory_order_relaxed);
+    refiller::instance().notify();
+    return nullptr;
+  }
+  if (node->capacity() < needed)
+  {
+    //dropped, while it sits in the slot the refiller would never make a bigger one
+    BumpAllocator::deallocate_block(node);
+    capacity.store(std::max(needed, capacity.load(std::memory_order_relaxed)),
+                   std::memory_order_relaxed);
+    refiller::instance().notify();
+    return nullptr;
+  }
+  //never smaller than what was just needed, so repeated large requests keep hitting
+  capacity.store(std::max(node->capacity(), std::min(node->capacity() * 2, 256UL * 1024UL)),
+                 std::memory_order_relaxed);
+  refiller::instance().notify();
+  return node;
+}
+
+refiller::refiller() : worker([this](std::stop_token stop) { run(stop); }) {}
+
+refiller& refiller::instance()
+{
+  static refiller instance;
+  return instance;
+}
+
+void refiller::add(refill_slot* slot)
+{
+  {
+    std::lock_guard lock(mutex);
+    slots.push_back(slot);
+    pending = true;
+  }
+  wake.notify_one();
+}
+
+void refiller::remove(refill_slot* slot)
+{
+  std::lock_guard lock(mutex);
+  std::erase(slots, slot);
+}
+
+void refiller::notify() noexcept
+{
+  {
+    std::lock_guard lock(mutex);
+    pending = true;
+  }
+  wake.notify_one();
+}
+
+void refiller::run(std::stop_token stop)
+{
+  std::unique_lock lock(mutex);
+  while (wake.wait(lock, stop, [this] { return pending; }))
+  {
+    pending = false;
+    std::vector<refill_slot*> snapshot = slots;
+    for (refill_slot* slot : snapshot)
+    {
+      if (std::ranges::find(slots, slot) == slots.end() ||
+          slot->spare.load(std::memory_order_acquire) != nullptr)
+      {
+        continue;
+      }
+      size_t capacity = slot->capacity.load(std::memory_order_relaxed);
+      int numa_node = slot->numa_node;
+
+      lock.unlock();
+      Node* block = BumpAllocator::allocate_block(capacity, numa_node);
+      BumpAllocator::prefault(block);
+      lock.lock();
+
+      Node* empty = nullptr;
+      if (std::ranges::find(slots, slot) == slots.end() ||
+          !slot->spare.compare_exchange_strong(empty, block, std::memory_order_release))
+      {
+        BumpAllocator::deallocate_block(block);
+      }
+    }
+  }
+}
@@ -0,0 +1,81 @@
+#include "bump/ring.h"
+
+#include <algorithm>
+#include <bit>
+#include <sys/mman.h>
+#include <unistd.h>
+
+using namespace bump;
+
+namespace
+{
+//the same pages twice, back to back. nullptr if memfd or the fixed mappings are not available
+std::byte* map_mirrored(size_t capacity) noexcept
+{
+#ifdef __linux__
+  int fd = ::memfd_create("bump::ring", MFD_CLOEXEC);
+  if (fd < 0)
+  {
+    return nullptr;
+  }
+  if (::ftruncate(fd, static_cast<off_t>(capacity)) != 0)
+  {
+    ::close(fd);
+    return nullptr;
+  }
+  //reserve both halves first so nothing else can be mapped in between
+  void* reserved = ::mmap(nullptr, 2 * capacity, PROT_NONE, MAP_PRIVATE | MAP_ANONYMOUS, -1, 0);
+  if (reserved == MAP_FAILED)
+  {
+    ::close(fd);
+    return nullptr;
+  }
+  auto* base = static_cast<std::byte*>(reserved);
+  for (std::byte* half: {base, base + capacity})
+  {
+    if (::mmap(half, capacity, PROT_READ | PROT_WRITE, MAP_SHARED | MAP_FIXED, fd, 0) == MAP_FAILED)
+    {
+      ::munmap(base, 2 * capacity);
+      ::close(fd);
+      return nullptr;
+    }
+  }
+  ::close(fd); //the mappings keep the file alive
+  return base;
+#else
+  return nullptr;
+#endif
+}
+} // namespace
+
+ring::ring(size_t capacity, bool mirrored) noexcept
+{
+  size_t page = ::sysconf(_SC_PAGESIZE);
+  capacity_ = std::bit_ceil(std::clamp(capacity, page, size_t{1} << 31));
+  if (mirrored)
+  {
+    base = map_mirrored(capacity_);
+    mirrored_ = base != nullptr;
+    mapped = mirrored_ ? 2 * capacity_ : 0;
+  }
+  if (base == nullptr)
+  {
+    void* plain = ::mmap(nullptr, capacity_, PROT_READ | PROT_WRITE, MAP_PRIVATE | MAP_ANONYMOUS,
+                         -1, 0);
+    if (plain == MAP_FAILED)
+    {
+      capacity_ = 0;
+      return;
+    }
+    base = static_cast<std::byte*>(plain);
+    mapped = capacity_;
+  }
+}
+
+ring::~ring() noexcept
+{
+  if (base)
+  {
+    ::munmap(base, mapped);
+  }
+}
@@ -0,0 +1,189 @@
+#include "bump/scheduler.h"
+
+#include <algorithm>
+#include <cstring>
+#include <new>
+
+using namespace bump;
+
+thread_local scheduler::worker* scheduler::current = nullptr;
+
+scheduler::scheduler(unsigned threads)
+{
+  threads = std::max(threads, 1U);
+  for (unsigned i = 0; i < threads; ++i)
+  {
+    workers.push_back(std::make_unique<worker>());
+    workers.back()->owner = this;
+  }
+  //thieves look at every worker, so all of them exist before the first thread starts
+  for (auto& self: workers)
+  {
+    this->threads.emplace_back([this, &self = *self] { work(self); });
+  }
+}
+
+scheduler::~scheduler()
+{
+  stop.store(true, std::memory_order_relaxed);
+  queued.fetch_add(1, std::memory_order_release);
+  queued.notify_all();
+  threads.clear();
+}
+
+BumpAllocator* scheduler::worker_arena() noexcept
+{
+  return current ? current->arena.operator->() : nullptr;
+}
+
+void scheduler::push(task* next)
+{
+  worker* self = current && current->owner == this ? current : nullptr;
+  if (self)
+  {
+    std::lock_guard lock(self->mutex);
+    self->tasks.push_back(next);
+  }
+  else
+  {
+    std::lock_guard lock(inject_mutex);
+    injected.push_back(next);
+  }
+  queued.fetch_add(1, std::memory_order_release);
+  queued.notify_one();
+}
+
+task* scheduler::pop(worker& self) noexcept
+{
+  std::lock_guard lock(self.mutex);
+  if (self.tasks.empty())
+  {
+    return nullptr;
+  }
+  task* next = self.tasks.back();
+  self.tasks.pop_back();
+  return next;
+}
+
+task* scheduler::steal(size_t first) noexcept
+{
+  for (size_t i = 0; i < workers.size(); ++i)
+  {
+    worker& victim = *workers[(first + i) % workers.size()];
+    std::lock_guard lock(victim.mutex);
+    if (!victim.tasks.empty())
+    {
+      task* next = victim.tasks.front();
+      victim.tasks.pop_front();
+      return next;
+    }
+  }
+  std::lock_guard lock(inject_mutex);
+  if (injected.empty())
+  {
+    return nullptr;
+  }
+  task* next = injected.front();
+  injected.pop_front();
+  return next;
+}
+
+task* scheduler::find(worker* self) noexcept
+{
+  if (queued.load(std::memory_order_acquire) == 0)
+  {
+    return nullptr;
+  }
+  task* next = self ? pop(*self) : nullptr;
+  if (next == nullptr)
+  {
+    size_t first = self ? static_cast<size_t>(self - workers.front().get()) : 0;
+    next = steal(self ? first + 1 : 0);
+  }
+  if (next)
+  {
+    queued.fetch_sub(1, std::memory_order_relaxed);
+  }
+  return next;
+}
+
+void scheduler::execute(worker& self, task& next) noexcept
+{
+  task_group* group = next.group;
+  {
+    BumpGuard frame(self.arena);
+    next.invoke(next, frame);
+  }
+  group->finished();
+}
+
+void scheduler::work(worker& self) noexcept
+{
+  current = &self;
+  while (!stop.load(std::memory_order_relaxed))
+  {
+    if (task* next = find(&self))
+    {
+      execute(self, *next);
+      continue;
+    }
+    queued.wait(0, std::memory_order_acquire);
+  }
+  current = nullptr;
+}
+
+template<typename Done>
+void scheduler::help(Done&& done, const std::atomic<size_t>& pending)
+{
+  worker* self = current && current->owner == this ? current : nullptr;
+  while (!done())
+  {
+    if (self == nullptr)
+    {
+      size_t left = pending.load(std::memory_order_acquire);
+      if (left != 0)
+      {
+        pending.wait(left, std::memory_order_acquire);
+      }
+      continue;
+    }
+    if (task* next = find(self))
+    {
+      execute(*self, *next);
+    }
+    else
+    {
+      std::this_thread::yield(); //the group's last tasks run on other workers
+    }
+  }
+}
+
+void task_group::finished() noexcept
+{
+  //the waiter may return as soon as pending hits 0, the lock keeps the group alive for notify_all
+  std::lock_guard lock(finish_mutex);
+  if (pending.fetch_sub(1, std::memory_order_acq_rel) == 1)
+  {
+    pending.notify_all();
+  }
+}
+
+void task_group::wait()
+{
+  pool.help([this] { return pending.load(std::memory_order_acquire) == 0; }, pending);
+  std::lock_guard lock(finish_mutex); //the last finished() is done with the group
+}
+
+void* task_group::keep(const void* data, size_t bytes, size_t align)
+{
+  void* copy;
+  {
+    std::lock_guard lock(mutex);
+    copy = results->allocate(bytes, align);
+  }
+  if (copy == nullptr)
+  {
+    throw std::bad_alloc();
+  }
+  return std::memcpy(copy, data, bytes);
+}
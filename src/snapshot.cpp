@@ -0,0 +1,82 @@
+#include "bump/snapshot.h"
+
+#include <cerrno>
+#include <fcntl.h>
+#include <unistd.h>
+
+using namespace bump;
+
+static bool write_all(int fd, const void* data, size_t bytes)
+{
+  auto* it = static_cast<const char*>(data);
+  while (bytes != 0)
+  {
+    ssize_t written = ::write(fd, it, bytes);
+    if (written < 0)
+    {
+      if (errno == EINTR)
+      {
+        continue;
+      }
+      return false;
+    }
+    it += written;
+    bytes -= written;
+  }
+  return true;
+}
+
+BumpAllocator::Frame bump::begin_snapshot(BumpAllocator& allocator, size_t capacity) noexcept
+{
+  allocator.reserve(capacity + snapshot_alignment);
+  allocator.allocate(0, snapshot_alignment);
+  return allocator.getFrame();
+}
+
+bool bump::write_snapshot(const char* path, BumpAllocator& allocator,
+                          const BumpAllocator::Frame& begin, const void* root) noexcept
+{
+  BumpAllocator::Frame::Iterator image(allocator, begin);
+  if (image.fragmented())
+  {
+    return false; //offsets between blocks would not survive the reload
+  }
+  std::span<std::byte> bytes = image.block();
+  auto* root_byte = static_cast<const std::byte*>(root);
+  if (root_byte < bytes.data() || root_byte > bytes.data() + bytes.size())
+  {
+    return false;
+  }
+
+  SnapshotHeader header;
+  header.size = bytes.size();
+  header.root = root_byte - bytes.data();
+
+  int fd = ::open(path, O_WRONLY | O_CREAT | O_TRUNC | O_CLOEXEC, 0644);
+  if (fd < 0)
+  {
+    return false;
+  }
+  bool success = write_all(fd, &header, sizeof(header)) && write_all(fd, bytes.data(), bytes.size());
+  return ::close(fd) == 0 && success;
+}
+
+const void* bump::load_snapshot(BumpAllocator& allocator, const char* path) noexcept
+{
+  auto frame = allocator.getFrame();
+  auto mapping = allocator.map_file(path);
+  if (!mapping)
+  {
+    return nullptr;
+  }
+  std::span<std::byte> file = mapping->block();
+  auto* header = reinterpret_cast<const SnapshotHeader*>(file.data());
+  if (file.size() < sizeof(SnapshotHeader) || header->magic != SnapshotHeader::MAGIC ||
+      header->version != SnapshotHeader::VERSION || header->pointer_size != sizeof(void*) ||
+      header->size != file.size() - sizeof(SnapshotHeader) || header->root > header->size)
+  {
+    allocator.restoreFrame(frame);
+    return nullptr;
+  }
+  return file.data() + sizeof(SnapshotHeader) + header->root;
+}
@@ -0,0 +1,80 @@
+#include "bump/thread_pool.h"
+
+using namespace bump;
+
+thread_pool::thread_pool(unsigned threads)
+{
+  for (unsigned i = 1; i < threads; ++i)
+  {
+    workers.emplace_back([this] { work(); });
+  }
+}
+
+thread_pool::~thread_pool()
+{
+  {
+    std::lock_guard lock(mutex);
+    stop = true;
+  }
+  wake.notify_all();
+  workers.clear();
+}
+
+void thread_pool::drain(const std::function<void(size_t)>& func, size_t count) noexcept
+{
+  for (size_t i = next.fetch_add(1, std::memory_order_relaxed); i < count;
+       i = next.fetch_add(1, std::memory_order_relaxed))
+  {
+    func(i);
+  }
+}
+
+void thread_pool::work() noexcept
+{
+  uint64_t seen = 0;
+  std::unique_lock lock(mutex);
+  while (true)
+  {
+    wake.wait(lock, [&] { return stop || generation != seen; });
+    if (stop)
+    {
+      return;
+    }
+    seen = generation;
+    if (job == nullptr)
+    {
+      continue; //woke up after the loop was already finished
+    }
+    const auto* func = job;
+    size_t count = jobs;
+    ++busy;
+    lock.unlock();
+
+    drain(*func, count);
+
+    lock.lock();
+    if (--busy == 0)
+    {
+      finished.notify_all();
+    }
+  }
+}
+
+void thread_pool::parallel_for(size_t count, const std::function<void(size_t)>& func)
+{
+  std::lock_guard serial(submit);
+  {
+    std::lock_guard lock(mutex);
+    job = &func;
+    jobs = count;
+    next.store(0, std::memory_order_relaxed);
+    ++generation;
+  }
+  wake.notify_all();
+
+  drain(func, count);
+
+  std::unique_lock lock(mutex);
+  finished.wait(lock, [&] { return busy == 0; });
+  job = nullptr;
+}
@@ -0,0 +1,48 @@
+#include "bump/async_reader.h"
+#include "check.h"
+
+#include <cerrno>
+#include <filesystem>
+#include <fstream>
+#include <string>
+#include <vector>
+
+using namespace bump;
+
+int main()
+{
+  auto directory = std::filesystem::temp_directory_path() / "bump_async_reader_test";
+  std::filesystem::create_directories(directory);
+  std::vector<std::string> names;
+  std::vector<std::string> contents;
+  for (int i = 0; i < 40; ++i)
+  {
+    names.push_back((directory / std::to_string(i)).string());
+    contents.push_back(std::string(i * 5000, static_cast<char>('a' + i % 26)));
+    std::ofstream(names.back(), std::ios::binary) << contents.back();
+  }
+  names.push_back((directory / "missing").string());
+  std::vector<const char*> paths;
+  for (auto& name: names)
+  {
+    paths.push_back(name.c_str());
+  }
+
+  //both backends, the ring with fewer slots than files so reads are queued behind each other
+  for (bool use_io_uring: {true, false})
+  {
+    allocator<4096> stack;
+    async_reader reader(8, use_io_uring);
+    auto files = reader.read(stack, paths);
+    CHECK(files.size() == paths.size());
+    for (size_t i = 0; i < contents.size(); ++i)
+    {
+      CHECK(files[i].error == 0);
+      std::string_view data(reinterpret_cast<const char*>(files[i].data.data()), files[i].data.size());
+      CHECK(data == contents[i]);
+    }
+    CHECK(files.back().error == ENOENT);
+    CHECK(files.back().data.empty());
+  }
+  std::filesystem::remove_all(directory);
+}
@@ -0,0 +1,52 @@
+#include "bump/blocks.h"
+#include "check.h"
+
+#include <algorithm>
+#include <atomic>
+#include <cstring>
+
+using namespace bump;
+
+int main()
+{
+  allocator<> arena;
+  BumpGuard guard(arena);
+  arena->allocate(24); //the range starts behind it
+  auto frame = arena->getFrame();
+  const size_t count = 2000;
+  for (size_t i = 0; i < count; ++i)
+  {
+    std::memset(arena->allocate(1000, 1), 1, 1000);
+  }
+
+  block_range blocks(arena, frame);
+  size_t bytes = 0;
+  for (std::span<std::byte> block : blocks)
+  {
+    bytes += block.size();
+    CHECK(std::ranges::all_of(block, [](std::byte b) { return b == std::byte{1}; }));
+  }
+  CHECK(bytes == count * 1000);
+  CHECK(std::ranges::distance(blocks) > 1);
+  CHECK(std::ranges::distance(blocks) == std::ranges::distance(blocks.begin(), blocks.end()));
+
+  fp_iterator iterator(arena, frame);
+  CHECK(iterator.count_bytes() == bytes);
+
+  //every byte is visited exactly once, whole blocks and grain sized parts alike
+  thread_pool pool(4);
+  for (size_t grain : {size_t{0}, size_t{4096}, size_t{1}})
+  {
+    std::atomic<size_t> seen = 0;
+    for_each_block(pool, blocks, [&](std::span<std::byte> part)
+    {
+      CHECK(grain == 0 || part.size() <= grain);
+      seen += std::ranges::count(part, std::byte{1});
+    }, grain);
+    CHECK(seen == bytes);
+  }
+
+  //an empty frame is an empty range
+  block_range empty(arena, arena->getFrame());
+  CHECK(std::ranges::all_of(empty, [](std::span<std::byte> block) { return block.empty(); }));
+}
@@ -0,0 +1,16 @@
+#pragma once
+#include <cstdio>
+#include <cstdlib>
+
+//assert that stays in release builds, a test aborts on the first failed check
+#define CHECK(condition)                                                                           \
+  ((condition) ? void(0) : bump_test::fail(#condition, __FILE__, __LINE__))
+
+namespace bump_test
+{
+[[noreturn]] inline void fail(const char* condition, const char* file, int line)
+{
+  std::fprintf(stderr, "%s:%d: check failed: %s\n", file, line, condition);
+  std::abort();
+}
+} // namespace bump_test
@@ -0,0 +1,132 @@
+#include "bump/coroutine.h"
+#include "check.h"
+
+#include <coroutine>
+#include <utility>
+
+using namespace bump;
+
+//minimal awaitable task whose frames go through arena_promise
+struct task
+{
+  struct promise_type : arena_promise
+  {
+    int value = 0;
+    std::coroutine_handle<> continuation;
+
+    task get_return_object()
+    {
+      return task{std::coroutine_handle<promise_type>::from_promise(*this)};
+    }
+    std::suspend_always initial_suspend() noexcept { return {}; }
+    struct resume_continuation
+    {
+      bool await_ready() noexcept { return false; }
+      std::coroutine_handle<> await_suspend(std::coroutine_handle<promise_type> self) noexcept
+      {
+        auto next = self.promise().continuation;
+        return next ? next : std::noop_coroutine();
+      }
+      void await_resume() noexcept {}
+    };
+    resume_continuation final_suspend() noexcept { return {}; }
+    void return_value(int result) { value = result; }
+    void unhandled_exception() { throw; }
+  };
+
+  std::coroutine_handle<promise_type> handle;
+
+  explicit task(std::coroutine_handle<promise_type> handle) : handle(handle) {}
+  task(task&& other) noexcept : handle(std::exchange(other.handle, {})) {}
+  ~task()
+  {
+    if (handle)
+    {
+      handle.destroy();
+    }
+  }
+
+  bool await_ready() { return false; }
+  std::coroutine_handle<> await_suspend(std::coroutine_handle<> caller)
+  {
+    handle.promise().continuation = caller;
+    return handle;
+  }
+  int await_resume() { return handle.promise().value; }
+  int run()
+  {
+    handle.resume();
+    return handle.promise().value;
+  }
+};
+
+task leaf(int x)
+{
+  co_return x * 2;
+}
+
+task chain(int depth)
+{
+  if (depth == 0)
+  {
+    co_return co_await leaf(1);
+  }
+  int value = co_await chain(depth - 1);
+  co_return value + 1;
+}
+
+task with_arena(BumpAllocator&, int x)
+{
+  co_return co_await leaf(x);
+}
+
+int main()
+{
+  //no arena anywhere: global heap
+  CHECK(chain(5).run() == 7);
+
+  allocator<4096> arena;
+  size_t before = arena->used();
+  {
+    //frames come from the scoped arena, LIFO destruction gives every byte back
+    scoped_arena scope(arena);
+    for (int i = 0; i < 1000; ++i)
+    {
+      CHECK(chain(10).run() == 12);
+    }
+    CHECK(arena->used() == before);
+
+    task pending = chain(3);
+    CHECK(arena->used() > before);
+    CHECK(pending.run() == 5);
+  }
+  CHECK(arena->used() == before);
+
+  //an arena argument (here a frame guard) is used directly
+  {
+    BumpGuard guard(arena);
+    task first = with_arena(guard, 21);
+    task second = with_arena(guard, 1);
+    CHECK(arena->used() > before);
+    CHECK(first.run() == 42 && second.run() == 2);
+  }
+  CHECK(arena->used() == before);
+
+  //frames bigger than the stack buffer move on to heap blocks
+  allocator<64> tiny;
+  {
+    BumpGuard guard(tiny);
+    task small = with_arena(tiny, 4);
+    CHECK(small.run() == 8);
+  }
+
+  //a sealed arena hands the frames to the global heap
+  arena->seal();
+  {
+    scoped_arena scope(arena);
+    task sealed = with_arena(arena, 5);
+    CHECK(sealed.run() == 10);
+    CHECK(chain(4).run() == 6);
+  }
+  arena->free();
+}
@@ -0,0 +1,186 @@
+#include "bump/flat_map.h"
+#include "check.h"
+
+#include <random>
+#include <string>
+#include <unordered_map>
+
+using namespace bump;
+
+namespace
+{
+//table of the map: slots, control bytes and the cloned group
+size_t storage_bytes(size_t capacity)
+{
+  return capacity * sizeof(std::pair<int, int>) + capacity + 15;
+}
+
+//long enough to live on the heap, leaked strings show up under LeakSanitizer
+std::string key_of(int i)
+{
+  return "flat_map key number " + std::to_string(i);
+}
+
+template<typename Map, typename Reference>
+bool same(const Map& map, const Reference& reference)
+{
+  size_t count = 0;
+  for (auto& [key, value]: map)
+  {
+    auto it = reference.find(key);
+    if (it == reference.end() || it->second != value)
+    {
+      return false;
+    }
+    ++count;
+  }
+  return count == map.size() && count == reference.size();
+}
+} // namespace
+
+int main()
+{
+  static allocator<256 * 1024> stack;
+  BumpAllocator& arena = stack;
+
+  //random insert / find / erase churn against std::unordered_map
+  {
+    BumpGuard guard(arena);
+    flat_map<std::string, int> map(arena);
+    std::unordered_map<std::string, int> reference;
+    std::mt19937 gen(7);
+    for (int step = 0; step < 100'000; ++step)
+    {
+      std::string key = key_of(gen() % 3000);
+      switch (gen() % 4)
+      {
+      case 0:
+      case 1:
+        map[key] = step;
+        reference[key] = step;
+        break;
+      case 2:
+        CHECK(map.erase(key) == (reference.erase(key) == 1));
+        break;
+      default:
+      {
+        auto it = map.find(key);
+        auto expected = reference.find(key);
+        CHECK((it == map.end()) == (expected == reference.end()));
+        CHECK(it == map.end() || it->second == expected->second);
+        CHECK(map.contains(key) == (expected != reference.end()));
+      }
+      }
+      if (step % 10'000 == 0)
+      {
+        CHECK(same(map, reference));
+      }
+    }
+    CHECK(same(map, reference));
+
+    flat_map<std::string, int> moved(std::move(map));
+    CHECK(map.empty() && same(moved, reference));
+    moved.clear();
+    CHECK(moved.empty() && moved.begin() == moved.end());
+  }
+
+  //a table full of tombstones is reused instead of grown
+  {
+    BumpGuard guard(arena);
+    flat_map<int, int> map(arena);
+    for (int i = 0; i < 14; ++i)
+    {
+      map[i] = i;
+    }
+    CHECK(map.capacity() == 16);
+    for (int round = 1; round <= 50; ++round)
+    {
+      for (int i = 0; i < 14; ++i)
+      {
+        CHECK(map.erase((round - 1) * 14 + i));
+      }
+      for (int i = 0; i < 14; ++i)
+      {
+        map[round * 14 + i] = i;
+      }
+      CHECK(map.capacity() == 16 && map.size() == 14);
+    }
+    for (int i = 0; i < 14; ++i)
+    {
+      CHECK(map.contains(50 * 14 + i) && !map.contains(49 * 14 + i));
+    }
+  }
+
+  //rehashing in place keeps every survivor findable
+  {
+    BumpGuard guard(arena);
+    flat_map<int, int> map(arena);
+    std::unordered_map<int, int> reference;
+    for (int i = 0; i < 56; ++i)
+    {
+      map[i] = reference[i] = i;
+    }
+    CHECK(map.capacity() == 64);
+    //half of the slots are tombstones, the next insert rehashes instead of growing
+    for (int i = 0; i < 56; i += 2)
+    {
+      map.erase(i);
+      reference.erase(i);
+    }
+    for (int i = 1000; map.size() < 56; ++i)
+    {
+      map[i] = reference[i] = i;
+    }
+    CHECK(map.capacity() == 64);
+    CHECK(same(map, reference));
+  }
+
+  //growing the most recent allocation extends it, nothing is left behind
+  {
+    BumpGuard guard(arena);
+    size_t before = arena.used();
+    flat_map<int, int> map(arena);
+    for (int i = 0; i < 1000; ++i)
+    {
+      map[i] = -i;
+    }
+    CHECK(map.capacity() == 2048);
+    size_t used = arena.used() - before;
+    CHECK(used >= storage_bytes(2048) && used < storage_bytes(2048) + alignof(int));
+    for (int i = 0; i < 1000; ++i)
+    {
+      CHECK(map.find(i)->second == -i);
+    }
+  }
+
+  //an allocation after the table forces growth to copy into a new one
+  {
+    BumpGuard guard(arena);
+    size_t before = arena.used();
+    flat_map<int, int> map(arena);
+    for (int i = 0; i < 1000; ++i)
+    {
+      map[i] = -i;
+      arena.allocate(1);
+    }
+    CHECK(map.capacity() == 2048);
+    CHECK(arena.used() - before > storage_bytes(2048) + storage_bytes(1024));
+    for (int i = 0; i < 1000; ++i)
+    {
+      CHECK(map.find(i)->second == -i);
+    }
+  }
+
+  //reserve sizes the table up front
+  {
+    BumpGuard guard(arena);
+    flat_map<int, int> map(arena, 1000);
+    size_t capacity = map.capacity();
+    CHECK(capacity == 2048);
+    for (int i = 0; i < 1000; ++i)
+    {
+      map[i] = i;
+    }
+    CHECK(map.capacity() == capacity);
+  }
+}
@@ -0,0 +1,33 @@
+#include "bump/bump.h"
+#include "bump/formatter.h"
+#include "check.h"
+
+#include <algorithm>
+#include <string>
+
+using namespace bump;
+
+int main()
+{
+  allocator<256> stack;
+  BumpAllocator& arena = stack;
+  arena.SetNumaNode(numa::local); //freshly mapped blocks, zero up to their end
+
+  {
+    BumpGuard guard(arena);
+    arena.allocate(1000);
+    CHECK(arena.current->zeroed <= arena.end());
+    //does not fit: format_to_n fills the tail of the block before the string moves on
+    std::string text(arena.remainingBytes() + 100, 'x');
+    Formatter formatter(guard);
+    auto formatted = formatter.format("{}", text);
+    CHECK(formatted == text);
+  }
+
+  //the same block again, its tail has to be cleared
+  BumpGuard guard(arena);
+  arena.allocate(1000);
+  size_t bytes = arena.remainingBytes();
+  auto* zeroes = static_cast<std::byte*>(arena.allocate_zeroed(bytes, 1));
+  CHECK(std::all_of(zeroes, zeroes + bytes, [](std::byte b) { return b == std::byte{0}; }));
+}
@@ -0,0 +1,44 @@
+#include "bump/HeapExport.h"
+#include "bump/bump.h"
+#include "check.h"
+
+#include <string>
+
+using namespace bump;
+
+int main()
+{
+#ifdef BUMP_TRACK_HEAP
+  allocator<256> arena("tab\there \"quoted\" back\\slash\nline\x01");
+  {
+    BumpGuard guard(arena);
+    for (int i = 0; i < 100; ++i)
+    {
+      arena->allocate(100);
+    }
+  }
+  arena->allocate(50);
+
+  std::string json = ToJson();
+  CHECK(json.starts_with("{\"arenas\":[") && json.ends_with("]}"));
+  CHECK(json.contains("\"name\":\"tab\\u0009here \\\"quoted\\\" back\\\\slash\\nline\\u0001\""));
+  for (char c: json)
+  {
+    CHECK(static_cast<unsigned char>(c) >= 0x20);
+  }
+
+  //label values only escape backslash, quote and newline, \u is no Prometheus escape
+  std::string prometheus = ToPrometheus();
+  CHECK(prometheus.contains("# TYPE bump_arena_slow_paths_total counter\n"));
+  CHECK(prometheus.contains(
+    "bump_arena_current_bytes{arena=\"tab\there \\\"quoted\\\" back\\\\slash\\nline\x01\","));
+  CHECK(!prometheus.contains("\\u"));
+  for (size_t line = 0, next; line < prometheus.size(); line = next + 1)
+  {
+    next = prometheus.find('\n', line);
+    CHECK(next != std::string::npos);
+    std::string_view sample(prometheus.data() + line, next - line);
+    CHECK(sample.starts_with("# ") || sample.starts_with("bump_arena_"));
+  }
+#endif
+}
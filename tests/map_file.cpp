@@ -0,0 +1,61 @@
+#include "bump/bump.h"
+#include "bump/formatter.h"
+#include "check.h"
+
+#include <filesystem>
+#include <fstream>
+#include <string>
+
+using namespace bump;
+
+int main()
+{
+  auto path = std::filesystem::temp_directory_path() / "bump_map_file_test.txt";
+  const size_t length = 3 << 20;
+  {
+    std::ofstream out(path, std::ios::binary);
+    out << std::string(length, 'x');
+  }
+
+  usage_profile profile;
+  allocator<4096> stack;
+  BumpAllocator& arena = stack;
+  arena.SetProfile(profile);
+  auto frame = arena.getFrame();
+  arena.allocate(100);
+  size_t before = arena.used();
+
+  auto file = arena.map_file(path.c_str());
+  CHECK(file && file->string_view().size() == length && !file->fragmented());
+  CHECK(file->string_view().find_first_not_of('x') == std::string_view::npos);
+  //only the MappedRegion record counts, not the file
+  CHECK(arena.used() - before < 256);
+  CHECK(arena.allocate(8000) != nullptr);
+  CHECK(arena.used() - before < 16 * 1024);
+#ifdef BUMP_TRACK_HEAP
+  CHECK(arena.info.total_malloc >= arena.info.total_free);
+  CHECK(arena.info.total_malloc - arena.info.total_free == arena.used());
+#endif
+
+  arena.restoreFrame(frame);
+  CHECK(arena.used() == 0);
+  CHECK(profile.hint() < 16 * 1024);
+#ifdef BUMP_TRACK_HEAP
+  CHECK(arena.info.total_free == arena.info.total_malloc);
+  CHECK(arena.info.peak_used < 16 * 1024);
+#endif
+
+  //the mapped block is full and read-only, a string formatted right after goes to the next block
+  {
+    std::ofstream(path, std::ios::binary | std::ios::trunc) << "small";
+    BumpGuard guard(arena);
+    auto small = arena.map_file(path.c_str());
+    CHECK(small && small->string_view() == "small");
+    auto text = Formatter(guard, '\0').format("{}-{}", "after", 5);
+    CHECK(text == "after-5" && text.data()[text.size()] == '\0');
+    CHECK(std::string_view(Formatter(guard, std::nullopt).format("{}", 42)) == "42");
+    CHECK(small->string_view() == "small");
+  }
+  CHECK(arena.used() == 0);
+  std::filesystem::remove(path);
+}
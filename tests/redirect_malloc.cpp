@@ -0,0 +1,67 @@
+#include "bump/redirect.h"
+#include "check.h"
+
+#include <cstdint>
+#include <cstdlib>
+#include <cstring>
+#include <malloc.h>
+
+using namespace bump;
+
+namespace
+{
+bool in_frame(const void* ptr)
+{
+  return redirect::size_of(ptr) != SIZE_MAX;
+}
+} // namespace
+
+//runs with LD_PRELOAD=libbump_malloc_shim.so, the shim binds to the hooks this program exports
+int main()
+{
+  allocator<4096> arena;
+  char* foreign = strdup("foreign");
+  CHECK(!in_frame(foreign));
+  {
+    redirect_scope scope(arena);
+    char* text = strdup("hello world");
+    CHECK(in_frame(text)); //fails if the shim is not preloaded or cannot see the hooks
+    CHECK(malloc_usable_size(text) == 12);
+
+    text = static_cast<char*>(realloc(text, 5000));
+    CHECK(in_frame(text) && std::strcmp(text, "hello world") == 0);
+
+    auto* zeroed = static_cast<char*>(calloc(100, 10));
+    CHECK(in_frame(zeroed));
+    for (int i = 0; i < 1000; ++i)
+    {
+      CHECK(zeroed[i] == 0);
+    }
+
+    void* aligned = nullptr;
+    CHECK(posix_memalign(&aligned, 256, 100) == 0);
+    CHECK(in_frame(aligned) && reinterpret_cast<std::uintptr_t>(aligned) % 256 == 0);
+
+    free(foreign); //foreign pointers go to glibc
+    free(text);
+    free(zeroed);
+    free(aligned);
+
+    //quadratic teardown check: thousands of blocks, every free stays cheap
+    static void* blocks[50000];
+    for (void*& block : blocks)
+    {
+      block = malloc(1000);
+    }
+    CHECK(in_frame(blocks[0]) && in_frame(blocks[49999]));
+    for (void* block : blocks)
+    {
+      free(block);
+    }
+  }
+  CHECK(arena->used() == 0);
+
+  void* after = malloc(10);
+  CHECK(!in_frame(after));
+  free(after);
+}
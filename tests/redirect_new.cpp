@@ -0,0 +1,71 @@
+#include "bump/redirect.h"
+#include "check.h"
+
+#include <cstdint>
+#include <memory>
+#include <string>
+#include <vector>
+
+using namespace bump;
+
+namespace
+{
+bool in_frame(const void* ptr)
+{
+  return redirect::size_of(ptr) != SIZE_MAX;
+}
+} // namespace
+
+//global operator new/delete come from redirect/operator_new.cpp (bump_operator_new)
+int main()
+{
+  allocator<4096> arena;
+  auto* outside = new std::vector<int>(10);
+  CHECK(!in_frame(outside));
+  void* before_scope = arena->allocate(64);
+  {
+    redirect_scope scope(arena);
+    CHECK(!in_frame(before_scope));
+    size_t used = arena->used();
+    auto strings = std::make_unique<std::vector<std::string>>();
+    CHECK(in_frame(strings.get()));
+    for (int i = 0; i < 1000; ++i)
+    {
+      strings->push_back(std::string(100, 'x'));
+    }
+    CHECK(arena->used() > used + 100000);
+    delete outside; //foreign pointers freed inside the scope go to the system heap
+
+    struct alignas(64) line
+    {
+      char bytes[64];
+    };
+    auto aligned = std::make_unique<line>();
+    CHECK(in_frame(aligned.get()) && reinterpret_cast<std::uintptr_t>(aligned.get()) % 64 == 0);
+
+    {
+      //the innermost scope gets the allocations, the last one is handed back on delete
+      allocator<256> inner_arena;
+      redirect_scope inner(inner_arena);
+      size_t outer_used = arena->used();
+      size_t inner_used = inner_arena->used();
+      auto* value = new int(3);
+      CHECK(in_frame(value) && inner_arena->used() > inner_used);
+      delete value;
+      CHECK(inner_arena->used() == inner_used && arena->used() == outer_used);
+    }
+
+    //many blocks: every delete finds its scope without walking the block chain
+    std::vector<std::unique_ptr<std::string>> many;
+    for (int i = 0; i < 20000; ++i)
+    {
+      many.push_back(std::make_unique<std::string>(200, 'y'));
+    }
+    CHECK(in_frame(many.front().get()) && in_frame(many.back().get()));
+  }
+  CHECK(arena->used() == 64);
+
+  auto* after = new int(1);
+  CHECK(!in_frame(after));
+  delete after;
+}
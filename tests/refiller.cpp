@@ -0,0 +1,57 @@
+#include "bump/refiller.h"
+#include "check.h"
+
+#include <chrono>
+#include <thread>
+
+using namespace bump;
+
+namespace
+{
+//the refiller runs in the background, give it a moment
+Node* wait_for_spare(refill_slot& slot)
+{
+  for (int i = 0; i < 1000; ++i)
+  {
+    if (Node* node = slot.spare.load(std::memory_order_acquire))
+    {
+      return node;
+    }
+    std::this_thread::sleep_for(std::chrono::milliseconds(1));
+  }
+  return nullptr;
+}
+} // namespace
+
+int main()
+{
+  const size_t large = 1 << 20;
+  allocator<> stack;
+  BumpAllocator& arena = stack;
+  arena.SetRefill(true);
+  CHECK(arena.refill != nullptr);
+
+  //small blocks come from the spare
+  Node* ready = wait_for_spare(*arena.refill);
+  CHECK(ready && ready->capacity() < large);
+  arena.allocate(6000);
+  CHECK(arena.current == ready);
+  arena.free();
+
+  //a request bigger than the spare misses once and raises the slot's capacity
+  CHECK(wait_for_spare(*arena.refill));
+  arena.allocate(large);
+  CHECK(arena.refill->capacity.load() >= large);
+  arena.free();
+
+  //after that the refiller keeps large spares ready, requests of that size hit
+  for (int i = 0; i < 5; ++i)
+  {
+    ready = wait_for_spare(*arena.refill);
+    CHECK(ready && ready->capacity() >= large);
+    arena.allocate(large);
+    CHECK(arena.current == ready);
+    arena.free();
+  }
+  arena.SetRefill(false);
+}
@@ -0,0 +1,111 @@
+#include "bump/ring.h"
+#include "check.h"
+
+#include <algorithm>
+#include <cstdint>
+#include <cstring>
+
+using namespace bump;
+
+namespace
+{
+//a message with granule alignment at the front of an empty ring sits right behind its header
+std::byte* base_of(ring& buffer)
+{
+  auto* first = static_cast<std::byte*>(buffer.allocate(8, 8));
+  buffer.pop();
+  return first - 8;
+}
+
+bool is_front(const ring& buffer, void* message, size_t size)
+{
+  auto front = buffer.front();
+  return front.data() == message && front.size() == size;
+}
+} // namespace
+
+int main()
+{
+  //without a mirror a message that does not fit the tail starts over at the front, aligned
+  {
+    ring buffer(1 << 16);
+    CHECK(buffer && !buffer.mirrored());
+    size_t capacity = buffer.capacity();
+    std::byte* base = base_of(buffer);
+
+    void* first = buffer.allocate(capacity / 2 - 8, 8);
+    void* second = buffer.allocate(capacity / 4 - 8, 8);
+    CHECK(first == base + 8 && second == base + capacity / 2 + 8);
+    buffer.pop();
+    void* wrapped = buffer.allocate(capacity / 4, 256);
+    CHECK(wrapped == base + 256);
+    CHECK(buffer.used() == capacity / 4 + capacity / 4 + 256 + capacity / 4);
+
+    //the wrap-around and the alignment padding are skipped on the way to the next message
+    CHECK(is_front(buffer, second, capacity / 4 - 8));
+    buffer.pop();
+    CHECK(is_front(buffer, wrapped, capacity / 4));
+    buffer.pop();
+    CHECK(buffer.empty() && buffer.front().empty() && buffer.used() == 0);
+
+    //an empty ring starts over at offset 0 wherever its head was
+    CHECK(buffer.allocate(16, 8) == base + 8);
+    buffer.pop();
+  }
+
+  //a message that ends exactly at the end of the buffer does not wrap
+  {
+    ring buffer(1 << 16);
+    size_t capacity = buffer.capacity();
+    std::byte* base = base_of(buffer);
+    void* first = buffer.allocate(capacity / 2 - 8, 8);
+    void* last = buffer.allocate(capacity / 2 - 8, 8);
+    CHECK(first == base + 8 && last == base + capacity / 2 + 8);
+    CHECK(buffer.used() == capacity);
+    CHECK(buffer.allocate(1, 8) == nullptr);
+    buffer.pop();
+    //the next one starts at the front, no fragment in front of it
+    CHECK(buffer.allocate(capacity / 2 - 8, 8) == base + 8);
+    CHECK(buffer.used() == capacity);
+    CHECK(buffer.allocate(capacity, 8) == nullptr);
+  }
+
+  //alignment padding between messages is skipped as well
+  {
+    ring buffer(1 << 16);
+    void* small = buffer.allocate(8, 8);
+    void* aligned = buffer.allocate(100, 64);
+    void* next = buffer.allocate(3, 8);
+    CHECK(reinterpret_cast<std::uintptr_t>(aligned) % 64 == 0);
+    CHECK(is_front(buffer, small, 8));
+    buffer.pop();
+    CHECK(is_front(buffer, aligned, 100));
+    buffer.pop();
+    CHECK(is_front(buffer, next, 3));
+    buffer.pop();
+    CHECK(buffer.empty());
+  }
+
+  //a mirrored ring keeps a message contiguous across the seam
+  {
+    ring buffer(1 << 16, true);
+    if (buffer.mirrored())
+    {
+      size_t capacity = buffer.capacity();
+      std::byte* base = base_of(buffer);
+      buffer.allocate(capacity / 2 - 8, 8);
+      void* second = buffer.allocate(capacity / 4 - 8, 8);
+      buffer.pop();
+      auto* seam = static_cast<std::byte*>(buffer.allocate(capacity / 2 - 8, 8));
+      CHECK(seam == base + capacity / 4 * 3 + 8);
+      std::memset(seam, 'x', capacity / 2 - 8);
+      //the part behind the seam is the front of the buffer
+      CHECK(std::all_of(base, base + capacity / 4, [](std::byte b) { return b == std::byte{'x'}; }));
+      CHECK(is_front(buffer, second, capacity / 4 - 8));
+      buffer.pop();
+      CHECK(is_front(buffer, seam, capacity / 2 - 8));
+      buffer.pop();
+      CHECK(buffer.empty());
+    }
+  }
+}
@@ -0,0 +1,71 @@
+#include "bump/bump.h"
+#include "check.h"
+
+#include <algorithm>
+
+using namespace bump;
+
+#ifdef BUMP_TRACK_HEAP
+[[gnu::noinline]] void site_a(BumpAllocator& arena)
+{
+  for (int i = 0; i < 10; ++i)
+  {
+    arena.allocate(100);
+  }
+}
+
+[[gnu::noinline]] void site_b(BumpAllocator& arena)
+{
+  for (int i = 0; i < 20; ++i)
+  {
+    arena.allocate(100);
+  }
+}
+
+[[gnu::noinline]] void site_guard(std::pmr::memory_resource& resource)
+{
+  for (int i = 0; i < 30; ++i)
+  {
+    resource.deallocate(resource.allocate(100, 8), 100, 8);
+  }
+}
+
+[[gnu::noinline]] void site_inline(BumpAllocator& arena)
+{
+  for (int i = 0; i < 5; ++i)
+  {
+    arena.allocate_inline(100, 8);
+  }
+}
+#endif
+
+int main()
+{
+#ifdef BUMP_TRACK_HEAP
+  allocator<4096> stack("sampled arena");
+  BumpAllocator& arena = stack;
+  arena.SetSampling(1);
+  {
+    BumpGuard guard(arena);
+    site_a(arena);
+    site_b(arena);
+    site_guard(guard);
+    site_inline(arena);
+  }
+
+  //every call site shows up on its own, none is folded into a wrapper of the allocator
+  auto top = arena.info.sites.Top(10);
+  CHECK(top.size() == 4);
+  auto has = [&](size_t count, size_t bytes)
+  {
+    return std::ranges::any_of(top, [&](const SiteProfile::Site& site)
+    {
+      return !site.tagged && site.count == count && site.bytes == bytes;
+    });
+  };
+  CHECK(has(30, 3000));
+  CHECK(has(20, 2000));
+  CHECK(has(10, 1000));
+  CHECK(has(5, 500));
+#endif
+}
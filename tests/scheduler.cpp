@@ -0,0 +1,39 @@
+#include "bump/scheduler.h"
+#include "check.h"
+
+#include <atomic>
+#include <memory>
+
+using namespace bump;
+
+int main()
+{
+  scheduler pool(4);
+
+  //groups are destroyed the moment wait() returns, while the last worker may still be in finished()
+  std::atomic<size_t> ran = 0;
+  for (int round = 0; round < 2000; ++round)
+  {
+    auto group = std::make_unique<task_group>(pool);
+    for (int i = 0; i < 3; ++i)
+    {
+      group->run([&](BumpGuard&) { ran.fetch_add(1, std::memory_order_relaxed); });
+    }
+    group->wait();
+    group.reset();
+  }
+  CHECK(ran == 6000);
+
+  //results kept by the tasks outlive them
+  task_group group(pool);
+  int* results[8];
+  for (int i = 0; i < 8; ++i)
+  {
+    group.run([&, i](BumpGuard&) { results[i] = group.keep(i * i); });
+  }
+  group.wait();
+  for (int i = 0; i < 8; ++i)
+  {
+    CHECK(*results[i] == i * i);
+  }
+}
@@ -0,0 +1,130 @@
+#include "bump/async_reader.h"
+#include "bump/bump.h"
+#include "bump/flat_map.h"
+#include "bump/formatter.h"
+#include "bump/frozen.h"
+#include "bump/scheduler.h"
+#include "bump/soa.h"
+#include "check.h"
+
+#include <cstring>
+#include <new>
+#include <string>
+#include <thread>
+
+using namespace bump;
+
+namespace
+{
+struct entry
+{
+  int key;
+  const char* name;
+};
+
+template<typename Func>
+bool throws_bad_alloc(Func&& func)
+{
+  try
+  {
+    func();
+  }
+  catch (const std::bad_alloc&)
+  {
+    return true;
+  }
+  return false;
+}
+} // namespace
+
+int main()
+{
+  //a sealed arena refuses every allocation instead of aborting, free() opens it again
+  {
+    allocator<256> stack;
+    BumpAllocator& arena = stack;
+    auto* kept = static_cast<char*>(arena.allocate(100));
+    std::memset(kept, 'k', 100);
+    size_t used = arena.used();
+    arena.seal();
+    CHECK(arena.sealed());
+    {
+      BumpGuard guard(arena);
+      CHECK(arena.allocate(8) == nullptr);
+      CHECK(arena.allocate(64 * 1024) == nullptr); //the slow path fails too
+      CHECK(arena.allocate_zeroed(8) == nullptr);
+      CHECK(!arena.try_extend(kept, 100, 150));
+    } //restoring the guard's frame keeps everything
+    CHECK(arena.used() == used);
+    CHECK(kept[99] == 'k');
+
+    arena.free();
+    CHECK(!arena.sealed());
+    CHECK(arena.used() == 0);
+    CHECK(arena.allocate(64 * 1024) != nullptr);
+  }
+
+  //what cannot return nullptr throws, and leaves its state as it was
+  {
+    allocator<4096> stack;
+    BumpAllocator& arena = stack;
+    BumpGuard guard(arena);
+    soa<int, double> rows(arena);
+    rows.push_back(1, 1.5);
+    flat_map<int, int> map(arena);
+    map[1] = 1;
+    arena.seal();
+
+    CHECK(throws_bad_alloc([&] { static_cast<std::pmr::memory_resource&>(guard).allocate(8); }));
+    CHECK(throws_bad_alloc([&] { rows.reserve(10000); }));
+    CHECK(rows.size() == 1 && rows.column<1>()[0] == 1.5);
+    CHECK(throws_bad_alloc([&] { map.reserve(10000); }));
+    CHECK(map.size() == 1 && map[1] == 1);
+
+    const char* path = "/proc/self/exe";
+    async_reader reader(8, false);
+    CHECK(throws_bad_alloc([&] { reader.read(arena, {&path, 1}); }));
+
+    //a child arena whose upstream is a frame of the sealed arena gets nullptr
+    allocator<256> child(&guard);
+    CHECK(child->allocate(64 * 1024) == nullptr);
+
+    scheduler pool(1);
+    task_group group(pool, &guard);
+    CHECK(throws_bad_alloc([&] { group.keep(std::array<char, 2048>{}); }));
+    arena.free();
+  }
+
+  //formatting into a sealed arena gives an empty view, with or without terminator
+  {
+    allocator<256> stack;
+    BumpAllocator& arena = stack;
+    BumpGuard guard(arena);
+    arena.allocate(10);
+    arena.seal();
+    CHECK(Formatter(guard, '\0').format("{} {}", "sealed", 42).empty());
+    CHECK(Formatter(guard, std::nullopt).format("{} {}", "sealed", 42).empty());
+    CHECK(Formatter(guard).nullstr("{}", std::string(1000, 'x')).empty());
+    arena.free();
+  }
+
+  //frozen data stays readable from other threads after the builder is gone
+  frozen<entry> shared;
+  {
+    freezable<> builder;
+    BumpAllocator& arena = builder.arena();
+    auto* root = arena.push<entry>();
+    auto* name = static_cast<char*>(arena.allocate(6, 1));
+    std::memcpy(name, "seven", 6);
+    *root = {7, name};
+    shared = std::move(builder).freeze(root, true);
+  }
+  frozen<entry> copy = shared;
+  std::thread reader([copy]
+  {
+    CHECK(copy->key == 7);
+    CHECK(std::strcmp(copy->name, "seven") == 0);
+  });
+  reader.join();
+  CHECK(shared.get() == copy.get());
+}
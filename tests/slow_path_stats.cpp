@@ -0,0 +1,49 @@
+#include "bump/bump.h"
+#include "check.h"
+
+#include <atomic>
+#include <thread>
+
+using namespace bump;
+
+int main()
+{
+#ifdef BUMP_TRACK_HEAP
+  //arenas that never leave their first block carry no histogram
+  static_assert(sizeof(TrackedAllocInfo) < sizeof(latency_histogram));
+  allocator<256> idle("idle arena");
+
+  //the owner records slow paths while another thread takes snapshots
+  std::atomic<bool> done = false;
+  std::thread owner([&]
+  {
+    allocator<256> busy("busy arena");
+    for (int round = 0; round < 200; ++round)
+    {
+      BumpGuard guard(busy);
+      for (int i = 0; i < 100; ++i)
+      {
+        busy->allocate(1000);
+      }
+      busy->free();
+    }
+    auto stats = HeapTracker::GetInstance().Snapshot();
+    auto it = std::ranges::find(stats, std::string("busy arena"), &ArenaStats::name);
+    CHECK(it != stats.end() && it->slow_paths > 0 && it->slow_path_p50_ns > 0);
+    CHECK(it->slow_path_p99_ns >= it->slow_path_p50_ns);
+    done = true;
+  });
+  while (!done)
+  {
+    for (const ArenaStats& arena : HeapTracker::GetInstance().Snapshot())
+    {
+      CHECK(arena.slow_path_p50_ns <= arena.slow_path_p99_ns);
+    }
+  }
+  owner.join();
+
+  auto stats = HeapTracker::GetInstance().Snapshot();
+  auto it = std::ranges::find(stats, std::string("idle arena"), &ArenaStats::name);
+  CHECK(it != stats.end() && it->slow_paths == 0 && it->slow_path_p99_ns == 0);
+#endif
+}
@@ -0,0 +1,75 @@
+#include "bump/snapshot.h"
+#include "check.h"
+
+#include <cstdio>
+#include <cstring>
+#include <filesystem>
+#include <fstream>
+
+using namespace bump;
+
+struct Entry
+{
+  offset_ptr<const char> name;
+  int value;
+  offset_ptr<Entry> next;
+};
+
+struct Table
+{
+  offset_ptr<Entry> head;
+  size_t count;
+};
+
+int main()
+{
+  auto path = std::filesystem::temp_directory_path() / "bump_snapshot_test.bin";
+  {
+    allocator<> arena;
+    auto begin = begin_snapshot(arena, 1 << 20);
+    auto* table = new (arena->push<Table>()) Table{};
+    for (int i = 0; i < 1000; ++i)
+    {
+      auto* name = static_cast<char*>(arena->allocateUnaligned(16));
+      std::snprintf(name, 16, "key%d", i);
+      table->head = new (arena->push<Entry>()) Entry{name, i, table->head.get()};
+      ++table->count;
+    }
+    CHECK(write_snapshot(path.c_str(), arena, begin, table));
+  }
+
+  //loaded at a different address, behind an unrelated allocation
+  allocator<> arena;
+  BumpGuard guard(arena);
+  arena->allocate(123);
+  auto* table = load_snapshot<Table>(arena, path.c_str());
+  CHECK(table && table->count == 1000);
+  int expected = 999;
+  for (const Entry* entry = table->head.get(); entry; entry = entry->next.get(), --expected)
+  {
+    char name[16];
+    std::snprintf(name, sizeof(name), "key%d", expected);
+    CHECK(entry->value == expected && std::strcmp(entry->name.get(), name) == 0);
+  }
+  CHECK(expected == -1);
+
+  //files without the header are refused
+  auto foreign = std::filesystem::temp_directory_path() / "bump_snapshot_foreign.bin";
+  {
+    std::ofstream out(foreign, std::ios::binary);
+    out << std::string(4096, 'x');
+  }
+  CHECK(load_snapshot<Table>(arena, foreign.c_str()) == nullptr);
+
+  //offset_ptr survives copying the memory it lives in
+  alignas(Entry) std::byte first[2 * sizeof(Entry)];
+  alignas(Entry) std::byte second[2 * sizeof(Entry)];
+  auto* last = new (first + sizeof(Entry)) Entry{nullptr, 2, nullptr};
+  new (first) Entry{nullptr, 1, last};
+  std::memcpy(second, first, sizeof(first));
+  auto* copy = reinterpret_cast<Entry*>(second);
+  CHECK(copy[0].next.get() == &copy[1] && copy[0].next->value == 2 && copy[1].next == nullptr);
+
+  std::filesystem::remove(path);
+  std::filesystem::remove(foreign);
+}
@@ -0,0 +1,61 @@
+#include "bump/soa.h"
+#include "check.h"
+
+#include <cstdint>
+#include <vector>
+
+using namespace bump;
+
+namespace
+{
+bool aligned(const void* ptr)
+{
+  return reinterpret_cast<std::uintptr_t>(ptr) % 64 == 0;
+}
+} // namespace
+
+int main()
+{
+  allocator<> arena;
+  soa<int, double, char> rows(arena);
+  CHECK(rows.empty());
+  for (int i = 0; i < 10000; ++i)
+  {
+    rows.push_back(i, i * 0.5, static_cast<char>(i));
+  }
+  CHECK(rows.size() == 10000 && rows.capacity() >= 10000);
+  for (int i = 0; i < 10000; ++i)
+  {
+    CHECK(rows.column<0>()[i] == i && rows.column<1>()[i] == i * 0.5);
+    CHECK(rows.column<2>()[i] == static_cast<char>(i));
+  }
+  CHECK(aligned(rows.column<0>().data()) && aligned(rows.column<1>().data()));
+  CHECK(aligned(rows.column<2>().data()));
+
+  //something allocated behind the columns: growing has to move them instead of extending
+  arena->allocate(8);
+  std::vector<int> xs(500, 7);
+  std::vector<double> ys(500, 1.5);
+  std::vector<char> zs(500, 'z');
+  rows.append(xs, ys, zs);
+  CHECK(rows.size() == 10500 && rows.column<0>()[9999] == 9999 && rows.column<0>()[10499] == 7);
+  CHECK(rows.column<1>()[10000] == 1.5 && rows.column<2>()[10250] == 'z');
+
+  //mostly grows in place as the last allocation, the columns are moved up inside it
+  soa<float, int> pairs(arena);
+  pairs.reserve(16);
+  pairs.push_back(1.f, 2);
+  pairs.resize(1000);
+  CHECK(pairs.column<0>()[0] == 1.f && pairs.column<1>()[0] == 2 && pairs.column<1>()[999] == 0);
+  for (int i = 0; i < 100000; ++i)
+  {
+    pairs.push_back(static_cast<float>(i), i);
+  }
+  CHECK(pairs.column<1>()[100999] == 99999 && pairs.column<0>()[0] == 1.f);
+  CHECK(aligned(pairs.column<1>().data()));
+
+  const auto& view = pairs;
+  CHECK(view.column<0>().size() == pairs.size());
+  pairs.clear();
+  CHECK(pairs.empty() && pairs.capacity() >= 101000);
+}
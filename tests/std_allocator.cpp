@@ -0,0 +1,63 @@
+#include "bump/std_allocator.h"
+#include "check.h"
+
+#include <map>
+#include <new>
+#include <vector>
+
+using namespace bump;
+
+namespace
+{
+allocator<4096> global_arena;
+
+template<typename Func>
+bool throws_bad_alloc(Func&& func)
+{
+  try
+  {
+    func();
+  }
+  catch (const std::bad_alloc&)
+  {
+    return true;
+  }
+  return false;
+}
+} // namespace
+
+int main()
+{
+  //containers allocate from the scoped arena
+  allocator<4096> arena;
+  {
+    scoped_arena scope(arena);
+    BumpGuard guard(arena);
+    std::vector<int, std_allocator<int>> numbers;
+    std::map<int, int, std::less<>, std_allocator<std::pair<const int, int>>> squares;
+    for (int i = 0; i < 1000; ++i)
+    {
+      numbers.push_back(i);
+      squares[i] = i * i;
+    }
+    CHECK(numbers[999] == 999 && squares[999] == 999 * 999);
+    CHECK(arena->used() > 1000 * sizeof(int));
+  }
+
+  //or from an arena bound at compile time
+  {
+    BumpGuard guard(global_arena);
+    std::vector<int, std_allocator<int, bound_arena<global_arena>>> numbers(100, 7);
+    CHECK(numbers[99] == 7);
+    CHECK(global_arena->used() >= 100 * sizeof(int));
+  }
+
+  //no arena to allocate from throws instead of handing nullptr to the container
+  CHECK(throws_bad_alloc([] { std::vector<int, std_allocator<int>>(10); }));
+  arena->seal();
+  {
+    scoped_arena scope(arena);
+    CHECK(throws_bad_alloc([] { std::vector<int, std_allocator<int>>(10); }));
+  }
+  arena->free();
+}
@@ -0,0 +1,96 @@
+#include "bump/bump.h"
+#include "check.h"
+
+#include <cstring>
+
+using namespace bump;
+
+namespace
+{
+size_t spare_blocks(BumpAllocator& arena)
+{
+  size_t count = 0;
+  for (Node* it = arena.root->next; it; it = it->next)
+  {
+    ++count;
+  }
+  return count;
+}
+
+size_t spare_bytes(BumpAllocator& arena)
+{
+  size_t bytes = 0;
+  for (Node* it = arena.root->next; it; it = it->next)
+  {
+    bytes += it->full_size();
+  }
+  return bytes;
+}
+
+void spike(BumpAllocator& arena)
+{
+  BumpGuard guard(arena);
+  for (int i = 0; i < 64; ++i)
+  {
+    std::memset(arena.allocate(256 * 1024), 1, 256 * 1024);
+  }
+}
+} // namespace
+
+int main()
+{
+  //idle blocks are freed once they were not used for max_idle_frames restores
+  {
+    allocator<> stack;
+    BumpAllocator& arena = stack;
+    arena.SetTrimPolicy(trim_policy{.max_idle_frames = 100, .interval = 16});
+    spike(arena);
+    CHECK(spare_blocks(arena) >= 64);
+    for (int i = 0; i < 50; ++i)
+    {
+      BumpGuard guard(arena);
+      arena.allocate(1000);
+    }
+    CHECK(spare_blocks(arena) >= 64); //not idle long enough yet
+    for (int i = 0; i < 100; ++i)
+    {
+      BumpGuard guard(arena);
+      arena.allocate(1000);
+    }
+    CHECK(spare_blocks(arena) == 0);
+  }
+
+  //release_pages keeps the blocks but gives their pages back
+  {
+    allocator<> stack;
+    BumpAllocator& arena = stack;
+    arena.SetTrimPolicy(trim_policy{.max_idle_frames = 10, .interval = 4, .release_pages = true});
+    spike(arena);
+    size_t blocks = spare_blocks(arena);
+    for (int i = 0; i < 20; ++i)
+    {
+      BumpGuard guard(arena);
+      arena.allocate(1000);
+    }
+    CHECK(spare_blocks(arena) == blocks);
+    for (Node* it = arena.root->next; it; it = it->next)
+    {
+      CHECK(it->last_used == Node::pages_released);
+    }
+    //released blocks are still usable
+    spike(arena);
+    CHECK(spare_blocks(arena) == blocks);
+  }
+
+  //the retained budget caps the bytes kept behind the current block
+  {
+    allocator<> stack;
+    BumpAllocator& arena = stack;
+    spike(arena);
+    CHECK(spare_bytes(arena) > (4 << 20));
+    arena.SetTrimPolicy(trim_policy{.retained_budget = 1 << 20});
+    arena.trim();
+    CHECK(spare_bytes(arena) <= (1 << 20));
+    CHECK(spare_blocks(arena) > 0);
+  }
+}
@@ -0,0 +1,27 @@
+#include "bump/bump.h"
+#include "check.h"
+
+#include <memory_resource>
+
+using namespace bump;
+
+int main()
+{
+  //blocks come from a frame of the parent arena and go away with it
+  {
+    allocator<4096> parent;
+    BumpGuard frame(parent);
+    allocator<256> child(&frame);
+    size_t before = parent->used();
+    CHECK(child->allocate(64 * 1024) != nullptr);
+    CHECK(parent->used() >= before + 64 * 1024);
+  }
+
+  //an upstream that is out of memory fails the allocation instead of terminating
+  {
+    allocator<256> child(std::pmr::null_memory_resource());
+    CHECK(child->allocate(50) != nullptr); //still fits the stack block
+    CHECK(child->allocate(64 * 1024) == nullptr);
+    CHECK(child->allocate(50) != nullptr);
+  }
+}